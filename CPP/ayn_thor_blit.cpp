@@ -0,0 +1,79 @@
+#include "ayn_thor_blit.h"
+
+namespace godot {
+
+#ifdef AYN_THOR_VULKAN
+void AynThorBlit::record(VkCommandBuffer command_buffer, VkImage p_source, const AynThorImageState& p_source_state, int32_t p_src_width, int32_t p_src_height, VkImage p_target, int32_t p_dst_width, int32_t p_dst_height) {
+    VkImageMemoryBarrier barrier_dst = {};
+    barrier_dst.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier_dst.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier_dst.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier_dst.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier_dst.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier_dst.image = p_target;
+    barrier_dst.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier_dst.subresourceRange.levelCount = 1;
+    barrier_dst.subresourceRange.layerCount = 1;
+    barrier_dst.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    VkImageMemoryBarrier barrier_src = {};
+    barrier_src.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier_src.oldLayout = p_source_state.layout;
+    barrier_src.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier_src.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier_src.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier_src.image = p_source;
+    barrier_src.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier_src.subresourceRange.levelCount = 1;
+    barrier_src.subresourceRange.layerCount = 1;
+    barrier_src.srcAccessMask = p_source_state.access;
+    barrier_src.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    // One call per side of the blit; the acquire semaphore wait gates
+    // COLOR_ATTACHMENT_OUTPUT, which is why it is in the source stages.
+    VkImageMemoryBarrier barriers_before[] = {barrier_dst, barrier_src};
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | p_source_state.stage, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, barriers_before);
+
+    VkImageBlit blit = {};
+    blit.srcOffsets[0] = {p_src_width, p_src_height, 0};
+    blit.srcOffsets[1] = {0, 0, 1};
+    blit.dstOffsets[0] = {0, 0, 0};
+    blit.dstOffsets[1] = {p_dst_width, p_dst_height, 1};
+    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.srcSubresource.layerCount = 1;
+    blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.dstSubresource.layerCount = 1;
+
+    vkCmdBlitImage(command_buffer, p_source, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, p_target, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+    VkImageMemoryBarrier barrier_present = {};
+    barrier_present.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier_present.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier_present.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier_present.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier_present.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier_present.image = p_target;
+    barrier_present.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier_present.subresourceRange.levelCount = 1;
+    barrier_present.subresourceRange.layerCount = 1;
+    barrier_present.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    VkImageMemoryBarrier barrier_restore = {};
+    barrier_restore.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier_restore.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier_restore.newLayout = p_source_state.layout;
+    barrier_restore.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier_restore.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier_restore.image = p_source;
+    barrier_restore.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier_restore.subresourceRange.levelCount = 1;
+    barrier_restore.subresourceRange.layerCount = 1;
+    barrier_restore.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier_restore.dstAccessMask = p_source_state.access;
+
+    VkImageMemoryBarrier barriers_after[] = {barrier_present, barrier_restore};
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT | p_source_state.stage, 0, 0, nullptr, 0, nullptr, 2, barriers_after);
+}
+#endif
+
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef AYN_THOR_BLIT_H
+#define AYN_THOR_BLIT_H
+
+// Vulkan paths are built on Android, and on Linux for the headless benchmark.
+#ifdef __ANDROID__
+#define VK_USE_PLATFORM_ANDROID_KHR
+#endif
+#if defined(__ANDROID__) || defined(AYN_THOR_HEADLESS)
+#define AYN_THOR_VULKAN
+#include <vulkan/vulkan.h>
+#endif
+
+#include <cstdint>
+
+namespace godot {
+
+#ifdef AYN_THOR_VULKAN
+// The layout a source image is handed over in, and the stage and access its
+// owner uses it with. Copies put the image back into the same state, so
+// nothing about Godot's render targets is assumed beyond what is passed.
+struct AynThorImageState {
+    VkImageLayout layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    VkPipelineStageFlags stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    VkAccessFlags access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+};
+#endif
+
+// The plain-blit copy of a source render target into a swapchain image,
+// shared by the renderer and the headless benchmark.
+class AynThorBlit {
+public:
+#ifdef AYN_THOR_VULKAN
+    // Takes the source from p_source_state and puts it back there; the
+    // target ends in PRESENT_SRC_KHR. The source is flipped by 180 degrees.
+    static void record(VkCommandBuffer command_buffer, VkImage p_source, const AynThorImageState& p_source_state, int32_t p_src_width, int32_t p_src_height, VkImage p_target, int32_t p_dst_width, int32_t p_dst_height);
+#endif
+};
+
+}
+
+#endif
\ No newline at end of file
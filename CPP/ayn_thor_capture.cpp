@@ -0,0 +1,590 @@
+#include "ayn_thor_capture.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#ifdef AYN_THOR_VULKAN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace godot {
+
+static size_t _align(size_t p_size, size_t p_alignment) {
+    return (p_size + p_alignment - 1) / p_alignment * p_alignment;
+}
+
+#ifdef AYN_THOR_VULKAN
+static bool _write_all(int p_fd, const void* p_data, size_t p_size) {
+    const uint8_t* data = (const uint8_t*)p_data;
+    while (p_size > 0) {
+        ssize_t written = write(p_fd, data, p_size);
+        if (written <= 0) return false;
+        data += written;
+        p_size -= (size_t)written;
+    }
+    return true;
+}
+
+// https://qoiformat.org/qoi-specification.pdf, four channels.
+static void _encode_qoi(const uint8_t* p_pixels, uint32_t p_width, uint32_t p_height, std::vector<uint8_t>& r_out) {
+    r_out.clear();
+    r_out.reserve((size_t)p_width * p_height * 2);
+    auto put32 = [&r_out](uint32_t p_value) {
+        r_out.push_back((uint8_t)(p_value >> 24));
+        r_out.push_back((uint8_t)(p_value >> 16));
+        r_out.push_back((uint8_t)(p_value >> 8));
+        r_out.push_back((uint8_t)p_value);
+    };
+    r_out.insert(r_out.end(), {'q', 'o', 'i', 'f'});
+    put32(p_width);
+    put32(p_height);
+    r_out.push_back(4);
+    r_out.push_back(0);
+
+    uint8_t index[64][4] = {};
+    uint8_t prev[4] = {0, 0, 0, 255};
+    uint32_t run = 0;
+    size_t count = (size_t)p_width * p_height;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* px = p_pixels + i * 4;
+        if (memcmp(px, prev, 4) == 0) {
+            run++;
+            if (run == 62 || i == count - 1) {
+                r_out.push_back((uint8_t)(0xc0 | (run - 1)));
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            r_out.push_back((uint8_t)(0xc0 | (run - 1)));
+            run = 0;
+        }
+
+        uint32_t hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+        if (memcmp(index[hash], px, 4) == 0) {
+            r_out.push_back((uint8_t)hash);
+        } else {
+            memcpy(index[hash], px, 4);
+            if (px[3] == prev[3]) {
+                int8_t vr = (int8_t)(px[0] - prev[0]);
+                int8_t vg = (int8_t)(px[1] - prev[1]);
+                int8_t vb = (int8_t)(px[2] - prev[2]);
+                int8_t vg_r = (int8_t)(vr - vg);
+                int8_t vg_b = (int8_t)(vb - vg);
+                if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+                    r_out.push_back((uint8_t)(0x40 | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2)));
+                } else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8) {
+                    r_out.push_back((uint8_t)(0x80 | (vg + 32)));
+                    r_out.push_back((uint8_t)((vg_r + 8) << 4 | (vg_b + 8)));
+                } else {
+                    r_out.insert(r_out.end(), {0xfe, px[0], px[1], px[2]});
+                }
+            } else {
+                r_out.insert(r_out.end(), {0xff, px[0], px[1], px[2], px[3]});
+            }
+        }
+        memcpy(prev, px, 4);
+    }
+    r_out.insert(r_out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+}
+#endif
+
+AynThorCapture::~AynThorCapture() {
+    stop();
+#ifdef AYN_THOR_VULKAN
+    cleanup_gpu();
+#endif
+}
+
+void AynThorCapture::configure(int p_fps, float p_scale) {
+    interval_ns.store(p_fps > 0 ? 1000000000ull / (uint64_t)p_fps : 0, std::memory_order_relaxed);
+    capture_scale.store(std::min(std::max(p_scale, 0.1f), 1.0f), std::memory_order_relaxed);
+}
+
+bool AynThorCapture::start(const Settings& p_settings) {
+    stop();
+#ifdef AYN_THOR_VULKAN
+    settings = p_settings;
+    configure(settings.fps, settings.scale);
+
+    int fd = -1;
+    if (settings.shared_path.empty()) {
+#ifdef __NR_memfd_create
+        fd = (int)syscall(__NR_memfd_create, "aynthor_capture", 0);
+#endif
+    } else {
+        fd = open(settings.shared_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    }
+    if (fd < 0) return false;
+    shared_fd.store(fd, std::memory_order_relaxed);
+    shared_sequence = 0;
+
+    if (!settings.file_path.empty()) {
+        file_fd = open(settings.file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (file_fd < 0) {
+            _close_outputs();
+            return false;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        writer_running = true;
+    }
+    writer_thread = std::thread(&AynThorCapture::_writer_loop, this);
+    active.store(true, std::memory_order_release);
+    return true;
+#else
+    (void)p_settings;
+    return false;
+#endif
+}
+
+void AynThorCapture::stop() {
+    active.store(false, std::memory_order_release);
+    if (writer_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(writer_mutex);
+            writer_running = false;
+        }
+        writer_cv.notify_all();
+        writer_thread.join();
+    }
+#ifdef AYN_THOR_VULKAN
+    {
+        // Frames the writer did not get to are dropped; in-flight ones are
+        // freed once their fence is seen.
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        for (int slot : ready_slots) {
+            slots[slot].state = SLOT_FREE;
+        }
+        ready_slots.clear();
+    }
+    idle_cv.notify_all();
+#endif
+    _close_outputs();
+}
+
+void AynThorCapture::_close_outputs() {
+#ifdef AYN_THOR_VULKAN
+    if (shared_map) munmap(shared_map, shared_size);
+    shared_map = nullptr;
+    shared_size = 0;
+    int fd = shared_fd.exchange(-1);
+    if (fd >= 0) close(fd);
+    if (file_fd >= 0) close(file_fd);
+    file_fd = -1;
+#endif
+}
+
+void AynThorCapture::_writer_loop() {
+    std::unique_lock<std::mutex> lock(writer_mutex);
+    while (true) {
+        writer_cv.wait(lock, [this]() { return !writer_running || !ready_slots.empty(); });
+        if (!writer_running) break;
+        int slot = ready_slots.front();
+        ready_slots.pop_front();
+
+        lock.unlock();
+        _write_frame(slot);
+        lock.lock();
+
+#ifdef AYN_THOR_VULKAN
+        slots[slot].state = SLOT_FREE;
+#endif
+        captured_frames.fetch_add(1, std::memory_order_relaxed);
+        idle_cv.notify_all();
+    }
+}
+
+void AynThorCapture::_write_frame(int p_slot) {
+#ifdef AYN_THOR_VULKAN
+    StagingSlot& slot = slots[p_slot];
+    if (!staging_coherent) {
+        VkMappedMemoryRange range = {};
+        range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        range.memory = slot.memory;
+        range.size = VK_WHOLE_SIZE;
+        vkInvalidateMappedMemoryRanges(device, 1, &range);
+    }
+    const uint8_t* pixels = (const uint8_t*)slot.mapped;
+    _publish(pixels, slot.width, slot.height, slot.rotation, slot.timestamp_ns);
+    if (file_fd >= 0) {
+        _append_file(pixels, slot.width, slot.height, slot.rotation, slot.timestamp_ns);
+    }
+#else
+    (void)p_slot;
+#endif
+}
+
+bool AynThorCapture::_resize_ring(uint32_t p_width, uint32_t p_height) {
+#ifdef AYN_THOR_VULKAN
+    size_t header_size = _align(sizeof(SharedHeader), 64);
+    size_t slot_stride = _align(sizeof(SlotHeader) + (size_t)p_width * p_height * 4, 64);
+    SharedHeader* header = (SharedHeader*)shared_map;
+    if (header && header->slot_stride == slot_stride) return true;
+
+    uint64_t generation = header ? header->generation.load(std::memory_order_relaxed) + 1 : 1;
+    if (shared_map) munmap(shared_map, shared_size);
+    shared_map = nullptr;
+
+    int fd = shared_fd.load(std::memory_order_relaxed);
+    size_t size = header_size + slot_stride * RING_SLOTS;
+    if (fd < 0 || ftruncate(fd, (off_t)size) != 0) return false;
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) return false;
+    shared_map = (uint8_t*)map;
+    shared_size = size;
+    memset(shared_map, 0, size);
+
+    header = new (shared_map) SharedHeader();
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->slot_count = RING_SLOTS;
+    header->header_size = (uint32_t)header_size;
+    header->slot_stride = slot_stride;
+    header->latest.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < RING_SLOTS; i++) {
+        new (shared_map + header_size + slot_stride * i) SlotHeader();
+    }
+    header->generation.store(generation, std::memory_order_release);
+    return true;
+#else
+    (void)p_width;
+    (void)p_height;
+    return false;
+#endif
+}
+
+void AynThorCapture::_publish(const uint8_t* p_pixels, uint32_t p_width, uint32_t p_height, uint32_t p_rotation, uint64_t p_timestamp_ns) {
+    if (!_resize_ring(p_width, p_height)) return;
+
+    SharedHeader* header = (SharedHeader*)shared_map;
+    uint64_t sequence = ++shared_sequence;
+    SlotHeader* slot = (SlotHeader*)(shared_map + header->header_size + header->slot_stride * ((sequence - 1) % RING_SLOTS));
+
+    // Zero marks the slot as being rewritten for readers that still hold it.
+    slot->sequence.store(0, std::memory_order_release);
+    slot->timestamp_ns = p_timestamp_ns;
+    slot->width = p_width;
+    slot->height = p_height;
+    slot->stride = p_width * 4;
+    slot->rotation = p_rotation;
+    memcpy((uint8_t*)slot + sizeof(SlotHeader), p_pixels, (size_t)p_width * p_height * 4);
+    slot->sequence.store(sequence, std::memory_order_release);
+    header->latest.store(sequence, std::memory_order_release);
+}
+
+void AynThorCapture::_append_file(const uint8_t* p_pixels, uint32_t p_width, uint32_t p_height, uint32_t p_rotation, uint64_t p_timestamp_ns) {
+#ifdef AYN_THOR_VULKAN
+    const uint8_t* payload = p_pixels;
+    size_t payload_size = (size_t)p_width * p_height * 4;
+    if (settings.file_format == FILE_QOI) {
+        _encode_qoi(p_pixels, p_width, p_height, encode_buffer);
+        payload = encode_buffer.data();
+        payload_size = encode_buffer.size();
+    }
+
+    FileFrameHeader frame_header = {};
+    frame_header.magic = FILE_MAGIC;
+    frame_header.format = (uint32_t)settings.file_format;
+    frame_header.width = p_width;
+    frame_header.height = p_height;
+    frame_header.rotation = p_rotation;
+    frame_header.payload_size = (uint32_t)payload_size;
+    frame_header.timestamp_ns = p_timestamp_ns;
+    if (!_write_all(file_fd, &frame_header, sizeof(frame_header)) || !_write_all(file_fd, payload, payload_size)) {
+        // Disk full or closed under us; keep feeding the shared ring.
+        close(file_fd);
+        file_fd = -1;
+    }
+#else
+    (void)p_pixels;
+    (void)p_width;
+    (void)p_height;
+    (void)p_rotation;
+    (void)p_timestamp_ns;
+#endif
+}
+
+#ifdef AYN_THOR_VULKAN
+bool AynThorCapture::init_gpu(VkPhysicalDevice p_physical_device, VkDevice p_device) {
+    physical_device = p_physical_device;
+    device = p_device;
+    return true;
+}
+
+void AynThorCapture::cleanup_gpu() {
+    if (!device) return;
+    {
+        // The writer may still be reading a staging buffer.
+        std::unique_lock<std::mutex> lock(writer_mutex);
+        for (int slot : ready_slots) {
+            slots[slot].state = SLOT_FREE;
+        }
+        ready_slots.clear();
+        idle_cv.wait(lock, [this]() {
+            for (const StagingSlot& slot : slots) {
+                if (slot.state == SLOT_WRITING) return false;
+            }
+            return true;
+        });
+        for (StagingSlot& slot : slots) {
+            slot.state = SLOT_FREE;
+        }
+    }
+    _release();
+    next_capture_ns = 0;
+    device = VK_NULL_HANDLE;
+    physical_device = VK_NULL_HANDLE;
+}
+
+uint32_t AynThorCapture::_find_memory_type(uint32_t p_type_bits, VkMemoryPropertyFlags p_flags) const {
+    VkPhysicalDeviceMemoryProperties memory_properties;
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++) {
+        if ((p_type_bits & (1u << i)) && (memory_properties.memoryTypes[i].propertyFlags & p_flags) == p_flags) {
+            return i;
+        }
+    }
+    return UINT32_MAX;
+}
+
+bool AynThorCapture::_allocate(VkExtent2D p_extent) {
+    _release();
+
+    // Intermediate image the swapchain is blitted into, which both scales
+    // and converts BGRA swapchains to RGBA.
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.extent = {p_extent.width, p_extent.height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkCreateImage(device, &imageInfo, nullptr, &capture_image) != VK_SUCCESS) {
+        capture_image = VK_NULL_HANDLE;
+        return false;
+    }
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(device, capture_image, &requirements);
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = requirements.size;
+    allocInfo.memoryTypeIndex = _find_memory_type(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (allocInfo.memoryTypeIndex == UINT32_MAX || vkAllocateMemory(device, &allocInfo, nullptr, &capture_memory) != VK_SUCCESS ||
+            vkBindImageMemory(device, capture_image, capture_memory, 0) != VK_SUCCESS) {
+        _release();
+        return false;
+    }
+
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = (VkDeviceSize)p_extent.width * p_extent.height * 4;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    for (StagingSlot& slot : slots) {
+        if (vkCreateBuffer(device, &bufferInfo, nullptr, &slot.buffer) != VK_SUCCESS) {
+            slot.buffer = VK_NULL_HANDLE;
+            _release();
+            return false;
+        }
+        vkGetBufferMemoryRequirements(device, slot.buffer, &requirements);
+        allocInfo.allocationSize = requirements.size;
+        // Cached memory makes the writer's reads much cheaper on mobile.
+        allocInfo.memoryTypeIndex = _find_memory_type(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+        staging_coherent = false;
+        if (allocInfo.memoryTypeIndex == UINT32_MAX) {
+            allocInfo.memoryTypeIndex = _find_memory_type(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            staging_coherent = true;
+        }
+        if (allocInfo.memoryTypeIndex == UINT32_MAX || vkAllocateMemory(device, &allocInfo, nullptr, &slot.memory) != VK_SUCCESS ||
+                vkBindBufferMemory(device, slot.buffer, slot.memory, 0) != VK_SUCCESS ||
+                vkMapMemory(device, slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.mapped) != VK_SUCCESS) {
+            _release();
+            return false;
+        }
+    }
+    capture_extent = p_extent;
+    return true;
+}
+
+void AynThorCapture::_release() {
+    for (StagingSlot& slot : slots) {
+        if (slot.mapped) vkUnmapMemory(device, slot.memory);
+        if (slot.buffer) vkDestroyBuffer(device, slot.buffer, nullptr);
+        if (slot.memory) vkFreeMemory(device, slot.memory, nullptr);
+        slot.mapped = nullptr;
+        slot.buffer = VK_NULL_HANDLE;
+        slot.memory = VK_NULL_HANDLE;
+    }
+    if (capture_image) vkDestroyImage(device, capture_image, nullptr);
+    if (capture_memory) vkFreeMemory(device, capture_memory, nullptr);
+    capture_image = VK_NULL_HANDLE;
+    capture_memory = VK_NULL_HANDLE;
+    capture_extent = {0, 0};
+}
+
+int AynThorCapture::record(VkCommandBuffer p_cmd, VkImage p_image, VkExtent2D p_extent, int p_rotation, uint64_t p_now_ns) {
+    if (!device || !is_active()) return -1;
+
+    uint64_t interval = interval_ns.load(std::memory_order_relaxed);
+    if (interval != 0) {
+        if (next_capture_ns != 0 && p_now_ns < next_capture_ns) return -1;
+        // Advance on the grid, but do not try to catch up after a stall.
+        next_capture_ns = (next_capture_ns == 0 || p_now_ns - next_capture_ns > interval) ? p_now_ns + interval : next_capture_ns + interval;
+    }
+
+    float scale = capture_scale.load(std::memory_order_relaxed);
+    VkExtent2D extent = {std::max(1u, (uint32_t)((float)p_extent.width * scale)), std::max(1u, (uint32_t)((float)p_extent.height * scale))};
+
+    int index = -1;
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        if (extent.width != capture_extent.width || extent.height != capture_extent.height) {
+            // Buffers are only reallocated once nothing references them.
+            for (const StagingSlot& slot : slots) {
+                if (slot.state != SLOT_FREE) {
+                    dropped_frames.fetch_add(1, std::memory_order_relaxed);
+                    return -1;
+                }
+            }
+            if (!_allocate(extent)) {
+                dropped_frames.fetch_add(1, std::memory_order_relaxed);
+                return -1;
+            }
+        }
+        for (uint32_t i = 0; i < STAGING_SLOTS; i++) {
+            if (slots[i].state == SLOT_FREE) {
+                index = (int)i;
+                break;
+            }
+        }
+        if (index < 0) {
+            dropped_frames.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        }
+        StagingSlot& slot = slots[index];
+        slot.state = SLOT_RECORDED;
+        slot.width = extent.width;
+        slot.height = extent.height;
+        slot.rotation = (uint32_t)p_rotation;
+        slot.timestamp_ns = p_now_ns;
+    }
+
+    VkImageMemoryBarrier barriers[2] = {};
+    for (VkImageMemoryBarrier& barrier : barriers) {
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.layerCount = 1;
+    }
+    barriers[0].image = p_image;
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    // The previous capture's copy-out is the only earlier user.
+    barriers[1].image = capture_image;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(p_cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 2, barriers);
+
+    VkImageBlit blit = {};
+    blit.srcOffsets[1] = {(int32_t)p_extent.width, (int32_t)p_extent.height, 1};
+    blit.dstOffsets[1] = {(int32_t)extent.width, (int32_t)extent.height, 1};
+    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.srcSubresource.layerCount = 1;
+    blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    blit.dstSubresource.layerCount = 1;
+    vkCmdBlitImage(p_cmd, p_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, capture_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+    barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[0].newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barriers[0].dstAccessMask = 0;
+    barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(p_cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 2, barriers);
+
+    VkBufferImageCopy region = {};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {extent.width, extent.height, 1};
+    vkCmdCopyImageToBuffer(p_cmd, capture_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slots[index].buffer, 1, &region);
+
+    VkBufferMemoryBarrier host_barrier = {};
+    host_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    host_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    host_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    host_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    host_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    host_barrier.buffer = slots[index].buffer;
+    host_barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(p_cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &host_barrier, 0, nullptr);
+    return index;
+}
+
+void AynThorCapture::submitted(int p_slot, uint32_t p_frame_slot, VkFence p_fence) {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    StagingSlot& slot = slots[p_slot];
+    slot.state = SLOT_IN_FLIGHT;
+    slot.frame_slot = p_frame_slot;
+    slot.fence = p_fence;
+}
+
+void AynThorCapture::cancel(int p_slot) {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    slots[p_slot].state = SLOT_FREE;
+}
+
+void AynThorCapture::retire(uint32_t p_frame_slot) {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    for (uint32_t i = 0; i < STAGING_SLOTS; i++) {
+        if (slots[i].state == SLOT_IN_FLIGHT && slots[i].frame_slot == p_frame_slot) _complete((int)i);
+    }
+}
+
+void AynThorCapture::retire_all() {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    for (uint32_t i = 0; i < STAGING_SLOTS; i++) {
+        if (slots[i].state == SLOT_IN_FLIGHT) _complete((int)i);
+    }
+}
+
+void AynThorCapture::poll() {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    for (uint32_t i = 0; i < STAGING_SLOTS; i++) {
+        // The fence cannot have been reset yet: the renderer only resets a
+        // frame slot's fence after waiting on it, which retires the slot.
+        if (slots[i].state == SLOT_IN_FLIGHT && vkGetFenceStatus(device, slots[i].fence) == VK_SUCCESS) _complete((int)i);
+    }
+}
+
+void AynThorCapture::_complete(int p_slot) {
+    if (writer_running) {
+        slots[p_slot].state = SLOT_WRITING;
+        ready_slots.push_back(p_slot);
+        writer_cv.notify_one();
+    } else {
+        slots[p_slot].state = SLOT_FREE;
+    }
+}
+#endif
+
+}
\ No newline at end of file
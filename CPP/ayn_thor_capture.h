@@ -0,0 +1,189 @@
+#ifndef AYN_THOR_CAPTURE_H
+#define AYN_THOR_CAPTURE_H
+
+#include "ayn_thor_blit.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace godot {
+
+// Copies presented frames into host-visible staging buffers from inside the
+// present command buffer and hands them to a writer thread once the GPU is
+// done. The present thread never waits: completion is picked up from fences
+// it already waits on, or polled with vkGetFenceStatus, and a frame is
+// skipped when every staging slot is still busy.
+//
+// The writer publishes RGBA8 frames into a shared-memory ring (an anonymous
+// memfd, or a file another process can mmap) and optionally appends them to
+// a raw or QOI file stream. Ring layout, all little-endian:
+//
+//   SharedHeader, then slot_count slots of slot_stride bytes, each a
+//   SlotHeader followed by height * stride bytes of pixels.
+//
+// A reader takes slot (latest - 1) % slot_count, and keeps the pixels only
+// if the slot's sequence equals latest before and after copying or using
+// them. A generation change means the ring was resized and must be remapped.
+class AynThorCapture {
+public:
+    enum FileFormat {
+        FILE_RAW,
+        FILE_QOI,
+    };
+
+    struct Settings {
+        // 0 captures every presented frame.
+        int fps = 0;
+        // Applied to the swapchain extent, 0.1 to 1.
+        float scale = 1.0f;
+        // Empty: anonymous memfd, see get_shared_fd().
+        std::string shared_path;
+        // Empty: no file stream.
+        std::string file_path;
+        FileFormat file_format = FILE_RAW;
+    };
+
+    static const uint32_t MAGIC = 0x50435441; // "ATCP"
+    static const uint32_t FILE_MAGIC = 0x46435441; // "ATCF"
+    static const uint32_t VERSION = 1;
+    static const uint32_t STAGING_SLOTS = 3;
+    static const uint32_t RING_SLOTS = 4;
+
+    struct SharedHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t slot_count;
+        uint32_t header_size;
+        uint64_t slot_stride;
+        std::atomic<uint64_t> generation;
+        std::atomic<uint64_t> latest;
+    };
+
+    struct SlotHeader {
+        std::atomic<uint64_t> sequence;
+        uint64_t timestamp_ns;
+        uint32_t width;
+        uint32_t height;
+        uint32_t stride;
+        // Pre-transform of the swapchain image, in degrees clockwise.
+        uint32_t rotation;
+    };
+
+    // Precedes every frame of the file stream.
+    struct FileFrameHeader {
+        uint32_t magic;
+        uint32_t format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t rotation;
+        uint32_t payload_size;
+        uint64_t timestamp_ns;
+    };
+
+    ~AynThorCapture();
+
+    // Main thread.
+    bool start(const Settings& p_settings);
+    void stop();
+    // Also valid while capturing; takes effect from the next frame.
+    void configure(int p_fps, float p_scale);
+    bool is_active() const { return active.load(std::memory_order_acquire); }
+    int get_shared_fd() const { return shared_fd.load(std::memory_order_relaxed); }
+    uint64_t get_captured_frames() const { return captured_frames.load(std::memory_order_relaxed); }
+    uint64_t get_dropped_frames() const { return dropped_frames.load(std::memory_order_relaxed); }
+
+#ifdef AYN_THOR_VULKAN
+    bool init_gpu(VkPhysicalDevice p_physical_device, VkDevice p_device);
+    void cleanup_gpu();
+
+    // Present thread. Records the copy of p_image, which must be in
+    // PRESENT_SRC_KHR and created with TRANSFER_SRC usage, and leaves it in
+    // PRESENT_SRC_KHR. Returns the staging slot or -1 when this frame is not
+    // captured.
+    int record(VkCommandBuffer p_cmd, VkImage p_image, VkExtent2D p_extent, int p_rotation, uint64_t p_now_ns);
+    void submitted(int p_slot, uint32_t p_frame_slot, VkFence p_fence);
+    void cancel(int p_slot);
+    // The frame slot's fence was waited on, so its captures are complete.
+    void retire(uint32_t p_frame_slot);
+    void retire_all();
+    // Non-blocking check of the remaining in-flight captures.
+    void poll();
+#endif
+
+private:
+    enum SlotState {
+        SLOT_FREE,
+        SLOT_RECORDED,
+        SLOT_IN_FLIGHT,
+        SLOT_WRITING,
+    };
+
+    std::atomic<bool> active{false};
+    std::atomic<int> shared_fd{-1};
+    std::atomic<uint64_t> captured_frames{0};
+    std::atomic<uint64_t> dropped_frames{0};
+    // Read by the present thread; the writer owns the rest of the settings.
+    std::atomic<uint64_t> interval_ns{0};
+    std::atomic<float> capture_scale{1.0f};
+    uint64_t next_capture_ns = 0;
+    Settings settings;
+
+    // Writer side; only the writer thread touches the ring and the file.
+    std::thread writer_thread;
+    std::mutex writer_mutex;
+    std::condition_variable writer_cv;
+    std::condition_variable idle_cv;
+    std::deque<int> ready_slots;
+    bool writer_running = false;
+    uint8_t* shared_map = nullptr;
+    size_t shared_size = 0;
+    uint64_t shared_sequence = 0;
+    int file_fd = -1;
+    std::vector<uint8_t> encode_buffer;
+
+    void _writer_loop();
+    void _write_frame(int p_slot);
+    bool _resize_ring(uint32_t p_width, uint32_t p_height);
+    void _publish(const uint8_t* p_pixels, uint32_t p_width, uint32_t p_height, uint32_t p_rotation, uint64_t p_timestamp_ns);
+    void _append_file(const uint8_t* p_pixels, uint32_t p_width, uint32_t p_height, uint32_t p_rotation, uint64_t p_timestamp_ns);
+    void _close_outputs();
+
+#ifdef AYN_THOR_VULKAN
+    struct StagingSlot {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        // Guarded by writer_mutex; the rest is stable while the slot is busy.
+        SlotState state = SLOT_FREE;
+        uint32_t frame_slot = 0;
+        VkFence fence = VK_NULL_HANDLE;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t rotation = 0;
+        uint64_t timestamp_ns = 0;
+    };
+
+    VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    StagingSlot slots[STAGING_SLOTS];
+    bool staging_coherent = true;
+    VkImage capture_image = VK_NULL_HANDLE;
+    VkDeviceMemory capture_memory = VK_NULL_HANDLE;
+    VkExtent2D capture_extent = {0, 0};
+
+    uint32_t _find_memory_type(uint32_t p_type_bits, VkMemoryPropertyFlags p_flags) const;
+    bool _allocate(VkExtent2D p_extent);
+    void _release();
+    void _complete(int p_slot);
+#endif
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "ayn_thor_direct_interface.h"
+#include "ayn_thor_renderer.h"
+#include <godot_cpp/classes/xr_server.hpp>
+
+namespace godot {
+
+StringName AynThorDirectInterface::_get_name() const { return "AynThorDirect"; }
+uint32_t AynThorDirectInterface::_get_capabilities() const { return XR_MONO; }
+bool AynThorDirectInterface::_is_initialized() const { return initialized; }
+
+bool AynThorDirectInterface::_initialize() {
+    XRServer* xr_server = XRServer::get_singleton();
+    if (!xr_server) return false;
+    initialized = true;
+    xr_server->set_primary_interface(this);
+    return true;
+}
+
+void AynThorDirectInterface::_uninitialize() {
+    XRServer* xr_server = XRServer::get_singleton();
+    if (xr_server && xr_server->get_primary_interface() == Ref<XRInterface>(this)) {
+        xr_server->set_primary_interface(Ref<XRInterface>());
+    }
+    initialized = false;
+}
+
+Vector2 AynThorDirectInterface::_get_render_target_size() {
+    return renderer ? renderer->_direct_target_size() : Vector2();
+}
+
+uint32_t AynThorDirectInterface::_get_view_count() { return 1; }
+
+Transform3D AynThorDirectInterface::_get_camera_transform() {
+    return renderer ? renderer->direct_camera_transform : Transform3D();
+}
+
+Transform3D AynThorDirectInterface::_get_transform_for_view(uint32_t p_view, const Transform3D& p_cam_transform) {
+    // The viewport's own camera is already in world space, so the XR
+    // origin is ignored.
+    return renderer ? renderer->direct_camera_transform : Transform3D();
+}
+
+PackedFloat64Array AynThorDirectInterface::_get_projection_for_view(uint32_t p_view, double p_aspect, double p_z_near, double p_z_far) {
+    Projection projection = renderer ? renderer->direct_camera_projection : Projection();
+    PackedFloat64Array result;
+    result.resize(16);
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            result.set(i * 4 + j, projection.columns[i][j]);
+        }
+    }
+    return result;
+}
+
+bool AynThorDirectInterface::_pre_draw_viewport(const RID& p_render_target) {
+    // False makes Godot skip the viewport, so paced-out frames cost nothing.
+    return renderer && renderer->_direct_acquire();
+}
+
+void AynThorDirectInterface::_post_draw_viewport(const RID& p_render_target, const Rect2& p_screen_rect) {}
+
+void AynThorDirectInterface::_end_frame() {
+    // Runs after Godot submitted the frame that rendered into the image.
+    if (renderer) renderer->_direct_present();
+}
+
+RID AynThorDirectInterface::_get_color_texture() {
+    return renderer ? renderer->_direct_texture() : RID();
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef AYN_THOR_DIRECT_INTERFACE_H
+#define AYN_THOR_DIRECT_INTERFACE_H
+
+#include <godot_cpp/classes/xr_interface_extension.hpp>
+
+namespace godot {
+
+class AynThorRenderer;
+
+// Single-view XR interface used only for its render target override: a
+// viewport with use_xr renders straight into the second-screen swapchain
+// image the renderer acquired for it, and the renderer presents that image
+// once Godot has submitted the frame. Callbacks run on the render thread,
+// which direct mode requires to be the main thread.
+class AynThorDirectInterface : public XRInterfaceExtension {
+    GDCLASS(AynThorDirectInterface, XRInterfaceExtension)
+
+    AynThorRenderer* renderer = nullptr;
+    bool initialized = false;
+
+protected:
+    static void _bind_methods() {}
+
+public:
+    void set_renderer(AynThorRenderer* p_renderer) { renderer = p_renderer; }
+
+    StringName _get_name() const override;
+    uint32_t _get_capabilities() const override;
+    bool _is_initialized() const override;
+    bool _initialize() override;
+    void _uninitialize() override;
+
+    Vector2 _get_render_target_size() override;
+    uint32_t _get_view_count() override;
+    Transform3D _get_camera_transform() override;
+    Transform3D _get_transform_for_view(uint32_t p_view, const Transform3D& p_cam_transform) override;
+    PackedFloat64Array _get_projection_for_view(uint32_t p_view, double p_aspect, double p_z_near, double p_z_far) override;
+
+    bool _pre_draw_viewport(const RID& p_render_target) override;
+    void _post_draw_viewport(const RID& p_render_target, const Rect2& p_screen_rect) override;
+    void _end_frame() override;
+    RID _get_color_texture() override;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "ayn_thor_display_registry.h"
+
+#include <algorithm>
+
+#ifdef __ANDROID__
+#include <android/native_window.h>
+#endif
+
+namespace godot {
+
+static uint64_t _pack_size(int32_t p_width, int32_t p_height) {
+    return ((uint64_t)(uint32_t)p_width << 32) | (uint32_t)p_height;
+}
+
+AynThorDisplayRegistry* AynThorDisplayRegistry::get_singleton() {
+    static AynThorDisplayRegistry registry;
+    return &registry;
+}
+
+void AynThorDisplayRegistry::add_listener(Listener* p_listener) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    listeners.push_back(p_listener);
+}
+
+void AynThorDisplayRegistry::remove_listener(Listener* p_listener) {
+    // Also waits out a notification already in flight, so the listener is
+    // never called once this returns.
+    std::lock_guard<std::mutex> notify_lock(notify_mutex);
+    std::lock_guard<std::mutex> lock(write_mutex);
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), p_listener), listeners.end());
+}
+
+void AynThorDisplayRegistry::_notify(int32_t p_display_id) {
+    std::lock_guard<std::mutex> notify_lock(notify_mutex);
+    std::vector<Listener*> targets;
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        targets = listeners;
+    }
+    for (Listener* listener : targets) {
+        listener->window_changed(p_display_id);
+    }
+}
+
+AynThorDisplayRegistry::Display* AynThorDisplayRegistry::find(int32_t p_display_id) {
+    if (p_display_id < 0) return nullptr;
+    for (Display& display : displays) {
+        if (display.display_id.load(std::memory_order_acquire) == p_display_id) return &display;
+    }
+    return nullptr;
+}
+
+int32_t AynThorDisplayRegistry::get_default_display_id() const {
+    for (const Display& display : displays) {
+        if (display.available.load(std::memory_order_acquire)) {
+            return display.display_id.load(std::memory_order_relaxed);
+        }
+    }
+    return -1;
+}
+
+AynThorDisplayRegistry::Display* AynThorDisplayRegistry::_find_or_add(int32_t p_display_id) {
+    Display* display = find(p_display_id);
+    if (display) return display;
+
+    // Slots are never handed back, only re-keyed once all are taken; readers
+    // of the old id then see its generation move and drop it.
+    for (Display& candidate : displays) {
+        if (candidate.display_id.load(std::memory_order_relaxed) < 0) {
+            candidate.display_id.store(p_display_id, std::memory_order_release);
+            return &candidate;
+        }
+    }
+    for (Display& candidate : displays) {
+        if (!candidate.available.load(std::memory_order_relaxed)) {
+            candidate.window_generation.fetch_add(1, std::memory_order_release);
+            candidate.display_id.store(p_display_id, std::memory_order_release);
+            return &candidate;
+        }
+    }
+    return nullptr;
+}
+
+void AynThorDisplayRegistry::set_window(int32_t p_display_id, void* p_window, int32_t p_width, int32_t p_height) {
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        Display* display = _find_or_add(p_display_id);
+        if (!display) {
+            release_window(p_window);
+            return;
+        }
+        if (display->window) {
+            release_window(display->window);
+        }
+        display->window = p_window;
+        display->size.store(_pack_size(p_width, p_height), std::memory_order_relaxed);
+        display->available.store(p_window != nullptr, std::memory_order_release);
+        display->window_generation.fetch_add(1, std::memory_order_release);
+    }
+    _notify(p_display_id);
+}
+
+void AynThorDisplayRegistry::surface_changed(int32_t p_display_id, int32_t p_width, int32_t p_height) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    Display* display = find(p_display_id);
+    if (!display || !display->window) return;
+    display->size.store(_pack_size(p_width, p_height), std::memory_order_relaxed);
+    display->surface_generation.fetch_add(1, std::memory_order_release);
+}
+
+void AynThorDisplayRegistry::set_refresh_rate(int32_t p_display_id, float p_refresh_rate) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    Display* display = _find_or_add(p_display_id);
+    if (display) {
+        display->refresh_rate.store(p_refresh_rate, std::memory_order_relaxed);
+    }
+}
+
+void AynThorDisplayRegistry::remove_window(int32_t p_display_id) {
+    {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        Display* display = find(p_display_id);
+        if (!display || !display->window) return;
+        release_window(display->window);
+        display->window = nullptr;
+        display->size.store(0, std::memory_order_relaxed);
+        display->available.store(false, std::memory_order_release);
+        display->window_generation.fetch_add(1, std::memory_order_release);
+    }
+    _notify(p_display_id);
+}
+
+void* AynThorDisplayRegistry::acquire_window(int32_t p_display_id, uint64_t& r_window_generation) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    Display* display = find(p_display_id);
+    if (!display || !display->window) return nullptr;
+#ifdef __ANDROID__
+    ANativeWindow_acquire((ANativeWindow*)display->window);
+#endif
+    r_window_generation = display->window_generation.load(std::memory_order_acquire);
+    return display->window;
+}
+
+void AynThorDisplayRegistry::release_window(void* p_window) {
+#ifdef __ANDROID__
+    if (p_window) ANativeWindow_release((ANativeWindow*)p_window);
+#else
+    (void)p_window;
+#endif
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef AYN_THOR_DISPLAY_REGISTRY_H
+#define AYN_THOR_DISPLAY_REGISTRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "ayn_thor_touch_ring.h"
+
+namespace godot {
+
+// Native windows of the secondary displays, keyed by Android display id.
+// The plugin's JNI calls are the only writers and serialise on a mutex.
+// Renderers poll the per-display atomics every frame and only take the lock
+// to grab the window itself after its generation changed.
+class AynThorDisplayRegistry {
+public:
+    static const int MAX_DISPLAYS = 4;
+
+    struct Display {
+        std::atomic<int32_t> display_id{-1};
+        std::atomic<bool> available{false};
+        // Bumped when the window is replaced or removed.
+        std::atomic<uint64_t> window_generation{0};
+        // Bumped when the current window changes size or format.
+        std::atomic<uint64_t> surface_generation{0};
+        // Width in the high and height in the low 32 bits.
+        std::atomic<uint64_t> size{0};
+        std::atomic<float> refresh_rate{0.0f};
+        TouchRing touch_ring;
+        // The one renderer that drains touch_ring; the ring has a single
+        // consumer.
+        std::atomic<const void*> touch_owner{nullptr};
+        // Guarded by the registry mutex.
+        void* window = nullptr;
+    };
+
+    // Told about every window that is set or removed, on the writer's
+    // thread after the registry lock is dropped; must not remove itself.
+    class Listener {
+    public:
+        virtual ~Listener() {}
+        virtual void window_changed(int32_t p_display_id) = 0;
+    };
+
+    static AynThorDisplayRegistry* get_singleton();
+
+    void add_listener(Listener* p_listener);
+    void remove_listener(Listener* p_listener);
+
+    // Writers. set_window takes over the caller's window reference.
+    void set_window(int32_t p_display_id, void* p_window, int32_t p_width, int32_t p_height);
+    void surface_changed(int32_t p_display_id, int32_t p_width, int32_t p_height);
+    void set_refresh_rate(int32_t p_display_id, float p_refresh_rate);
+    void remove_window(int32_t p_display_id);
+
+    // Lock-free lookup; null if the display was never registered.
+    Display* find(int32_t p_display_id);
+    // The first display that currently has a window, or -1.
+    int32_t get_default_display_id() const;
+
+    // Returns the display's window with an extra reference the caller must
+    // drop with release_window, plus the generation it belongs to.
+    void* acquire_window(int32_t p_display_id, uint64_t& r_window_generation);
+    static void release_window(void* p_window);
+
+private:
+    Display displays[MAX_DISPLAYS];
+    std::mutex write_mutex;
+    // Held while listeners are told, so remove_listener can wait them out.
+    std::mutex notify_mutex;
+    // Guarded by write_mutex.
+    std::vector<Listener*> listeners;
+
+    Display* _find_or_add(int32_t p_display_id);
+    void _notify(int32_t p_display_id);
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "ayn_thor_dynamic_resolution.h"
+#include <algorithm>
+#include <cmath>
+
+namespace godot {
+
+void AynThorDynamicResolution::configure(float p_min_scale, float p_max_scale, double p_budget_usec) {
+    min_scale = std::clamp(p_min_scale, STEP, 1.0f);
+    max_scale = std::clamp(p_max_scale, min_scale, 1.0f);
+    budget_usec = std::max(p_budget_usec, 100.0);
+    scale = std::clamp(scale, min_scale, max_scale);
+}
+
+bool AynThorDynamicResolution::update(double p_gpu_usec) {
+    if (p_gpu_usec <= 0.0) return false;
+
+    // Light smoothing: a single spike should not cost resolution, a second
+    // of heavy frames should.
+    smoothed_usec = smoothed_usec < 0.0 ? p_gpu_usec : smoothed_usec + (p_gpu_usec - smoothed_usec) * 0.2;
+
+    if (smoothed_usec > budget_usec * SHRINK_ABOVE) {
+        over_budget_samples++;
+        under_budget_samples = 0;
+    } else if (smoothed_usec < budget_usec * GROW_BELOW) {
+        under_budget_samples++;
+        over_budget_samples = 0;
+    } else {
+        over_budget_samples = 0;
+        under_budget_samples = 0;
+    }
+
+    float target = scale;
+    if (over_budget_samples >= SHRINK_SAMPLES) {
+        target = scale * (float)std::sqrt(budget_usec / smoothed_usec);
+        // Whole steps, and at least one, so sizes repeat instead of drifting.
+        target = std::min(std::floor(target / STEP) * STEP, scale - STEP);
+    } else if (under_budget_samples >= GROW_SAMPLES) {
+        target = scale + STEP;
+    }
+    target = std::clamp(target, min_scale, max_scale);
+    if (std::fabs(target - scale) < STEP * 0.5f) return false;
+
+    scale = target;
+    // Timings from the old size say little about the new one.
+    smoothed_usec = -1.0;
+    over_budget_samples = 0;
+    under_budget_samples = 0;
+    return true;
+}
+
+void AynThorDynamicResolution::reset() {
+    scale = max_scale;
+    smoothed_usec = -1.0;
+    over_budget_samples = 0;
+    under_budget_samples = 0;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef AYN_THOR_DYNAMIC_RESOLUTION_H
+#define AYN_THOR_DYNAMIC_RESOLUTION_H
+
+#include <cstdint>
+
+namespace godot {
+
+// Picks a render scale for the second viewport from its measured GPU time.
+// GPU time is taken to follow the pixel count, so an over-budget frame time
+// shrinks the scale by the square root of the overshoot. Growing only
+// happens a step at a time after a long run of comfortably cheap frames,
+// and the band in between changes nothing, so a scene near the budget does
+// not make the viewport resize back and forth.
+class AynThorDynamicResolution {
+    float min_scale = 0.5f;
+    float max_scale = 1.0f;
+    double budget_usec = 4000.0;
+
+    float scale = 1.0f;
+    double smoothed_usec = -1.0;
+    int over_budget_samples = 0;
+    int under_budget_samples = 0;
+
+public:
+    static constexpr float STEP = 0.05f;
+    // Consecutive samples needed before shrinking and before growing.
+    static const int SHRINK_SAMPLES = 6;
+    static const int GROW_SAMPLES = 60;
+    // Budget fractions outside of which the counters run.
+    static constexpr double SHRINK_ABOVE = 1.05;
+    static constexpr double GROW_BELOW = 0.75;
+
+    void configure(float p_min_scale, float p_max_scale, double p_budget_usec);
+
+    // Feeds one frame's GPU time; returns true when the scale changed.
+    bool update(double p_gpu_usec);
+    float get_scale() const { return scale; }
+    double get_smoothed_usec() const { return smoothed_usec; }
+
+    // Back to the maximum scale with no history.
+    void reset();
+};
+
+}
+
+#endif
\ No newline at end of file
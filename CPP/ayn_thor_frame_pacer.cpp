@@ -0,0 +1,85 @@
+#include "ayn_thor_frame_pacer.h"
+#include <cmath>
+
+namespace godot {
+
+void AynThorFramePacer::set_refresh_period(uint64_t p_period_ns) {
+    if (p_period_ns == 0) return;
+    refresh_period_ns.store(p_period_ns, std::memory_order_relaxed);
+}
+
+void AynThorFramePacer::configure(int p_target_fps, int p_divisor) {
+    uint64_t period = refresh_period_ns.load(std::memory_order_relaxed);
+    if (p_divisor > 0) {
+        divisor = p_divisor;
+    } else if (p_target_fps > 0) {
+        double frames = (1e9 / (double)p_target_fps) / (double)period;
+        divisor = frames < 1.0 ? 1 : (int)std::lround(frames);
+    } else {
+        divisor = 0;
+    }
+    interval_ns.store(period * (uint64_t)divisor, std::memory_order_relaxed);
+    next_deadline_ns = 0;
+    previous_deadline_ns = 0;
+}
+
+bool AynThorFramePacer::tick(uint64_t p_now_ns) {
+    uint64_t interval = interval_ns.load(std::memory_order_relaxed);
+    if (interval == 0) return true;
+
+    uint64_t period = refresh_period_ns.load(std::memory_order_relaxed);
+    uint64_t slack = period / 2;
+    if (next_deadline_ns == 0) {
+        next_deadline_ns = p_now_ns;
+    }
+    if (p_now_ns + slack < next_deadline_ns) {
+        return false;
+    }
+
+    previous_deadline_ns = next_deadline_ns;
+    next_deadline_ns += interval;
+    if (next_deadline_ns + slack <= p_now_ns) {
+        // More than a whole interval behind (hitch, pause): resync instead of
+        // bursting frames to catch up.
+        next_deadline_ns = p_now_ns + interval;
+    }
+
+    // Keep the deadline on the panel's vsync grid once we know where it is.
+    uint64_t anchor_time = anchor_ns.load(std::memory_order_relaxed);
+    if (anchor_time != 0) {
+        int64_t offset = (int64_t)(next_deadline_ns - anchor_time) % (int64_t)period;
+        if (offset < 0) offset += (int64_t)period;
+        if (offset > (int64_t)slack) offset -= (int64_t)period;
+        next_deadline_ns -= offset;
+    }
+    return true;
+}
+
+void AynThorFramePacer::anchor(uint64_t p_present_ns) {
+    anchor_ns.store(p_present_ns, std::memory_order_relaxed);
+}
+
+uint64_t AynThorFramePacer::desired_present_time(uint64_t p_now_ns) const {
+    uint64_t anchor_time = anchor_ns.load(std::memory_order_relaxed);
+    uint64_t interval = interval_ns.load(std::memory_order_relaxed);
+    if (anchor_time == 0 || interval == 0) return 0;
+
+    uint64_t earliest = p_now_ns + refresh_period_ns.load(std::memory_order_relaxed) / 2;
+    if (earliest <= anchor_time) return anchor_time + interval;
+    uint64_t steps = (earliest - anchor_time + interval - 1) / interval;
+    return anchor_time + steps * interval;
+}
+
+void AynThorFramePacer::cancel_tick() {
+    if (previous_deadline_ns == 0) return;
+    next_deadline_ns = previous_deadline_ns;
+    previous_deadline_ns = 0;
+}
+
+void AynThorFramePacer::reset() {
+    next_deadline_ns = 0;
+    previous_deadline_ns = 0;
+    anchor_ns.store(0, std::memory_order_relaxed);
+}
+
+}
\ No newline at end of file
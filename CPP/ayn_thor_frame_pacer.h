@@ -0,0 +1,53 @@
+#ifndef AYN_THOR_FRAME_PACER_H
+#define AYN_THOR_FRAME_PACER_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace godot {
+
+// Decides which ticks of the game loop produce a second-screen frame. The
+// interval is always a whole multiple of the panel's refresh period, and the
+// deadline advances by that interval rather than from "now", so jitter in the
+// game loop does not turn 33 ms into 33/50 ms alternation.
+class AynThorFramePacer {
+    // Written on the main thread, read by the present thread as well.
+    std::atomic<uint64_t> refresh_period_ns{16666667};
+    std::atomic<uint64_t> interval_ns{0};
+    int divisor = 0;
+    uint64_t next_deadline_ns = 0;
+    uint64_t previous_deadline_ns = 0;
+
+    // Time a frame was last seen on the panel, written from whichever thread
+    // observes presentation timing.
+    std::atomic<uint64_t> anchor_ns{0};
+
+public:
+    // Takes effect on the next configure().
+    void set_refresh_period(uint64_t p_period_ns);
+    uint64_t get_refresh_period_ns() const { return refresh_period_ns.load(std::memory_order_relaxed); }
+
+    // p_divisor > 0 wins; otherwise the target fps is snapped to the nearest
+    // divisor of the refresh rate. Both zero disables pacing.
+    void configure(int p_target_fps, int p_divisor);
+    uint64_t get_interval_ns() const { return interval_ns.load(std::memory_order_relaxed); }
+    int get_divisor() const { return divisor; }
+
+    // Returns true when the frame for this tick should be produced.
+    bool tick(uint64_t p_now_ns);
+    // Gives back the slot of the last tick() that returned true, for a
+    // frame that was not presented after all.
+    void cancel_tick();
+
+    void anchor(uint64_t p_present_ns);
+
+    // Earliest vsync-aligned time at least half a refresh after p_now_ns on
+    // the interval grid, or 0 while no presentation has been observed.
+    uint64_t desired_present_time(uint64_t p_now_ns) const;
+
+    void reset();
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "ayn_thor_frame_stats.h"
+#include <algorithm>
+#include <cmath>
+
+namespace godot {
+
+static const char* METRIC_NAMES[AynThorFrameStats::METRIC_MAX] = {
+    "fence_wait",
+    "acquire",
+    "record",
+    "submit",
+    "present",
+    "cpu_total",
+    "gpu_copy",
+};
+
+AynThorFrameStats::~AynThorFrameStats() {
+    stop_trace();
+}
+
+const char* AynThorFrameStats::get_metric_name(Metric p_metric) {
+    return p_metric >= 0 && p_metric < METRIC_MAX ? METRIC_NAMES[p_metric] : "";
+}
+
+void AynThorFrameStats::record(const FrameTiming& p_timing) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int i = 0; i < METRIC_MAX; i++) {
+        if (p_timing.usec[i] >= 0.0) _push((Metric)i, p_timing.usec[i]);
+    }
+    if (trace_file) _write_trace(p_timing);
+}
+
+void AynThorFrameStats::_push(Metric p_metric, double p_usec) {
+    Window& window = windows[p_metric];
+    window.samples[window.next] = p_usec;
+    window.next = (window.next + 1) % WINDOW;
+    if (window.count < WINDOW) window.count++;
+    window.cached = false;
+}
+
+AynThorFrameStats::Percentiles AynThorFrameStats::get_percentiles(Metric p_metric) {
+    if (p_metric < 0 || p_metric >= METRIC_MAX) return Percentiles();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Window& window = windows[p_metric];
+    if (window.cached) return window.percentiles;
+
+    Percentiles result;
+    result.count = window.count;
+    if (window.count > 0) {
+        scratch.assign(window.samples, window.samples + window.count);
+        std::sort(scratch.begin(), scratch.end());
+        // Nearest-rank, so a p99 over a short window is still a real sample.
+        auto rank = [this](double p_fraction) {
+            size_t index = (size_t)std::ceil(p_fraction * (double)scratch.size());
+            return scratch[index > 0 ? index - 1 : 0];
+        };
+        result.p50 = rank(0.50);
+        result.p95 = rank(0.95);
+        result.p99 = rank(0.99);
+    }
+    window.percentiles = result;
+    window.cached = true;
+    return result;
+}
+
+void AynThorFrameStats::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Window& window : windows) {
+        window.count = 0;
+        window.next = 0;
+        window.cached = false;
+    }
+}
+
+bool AynThorFrameStats::start_trace(const std::string& p_path, TraceFormat p_format) {
+    stop_trace();
+
+    FILE* file = std::fopen(p_path.c_str(), "w");
+    if (!file) return false;
+    // Keep the present thread out of the kernel for most frames.
+    std::setvbuf(file, nullptr, _IOFBF, 64 * 1024);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    trace_file = file;
+    trace_format = p_format;
+    trace_origin_ns = 0;
+    trace_frame = 0;
+    trace_first_event = true;
+    if (trace_format == TRACE_CSV) {
+        std::fprintf(trace_file, "frame,start_us");
+        for (int i = 0; i < METRIC_MAX; i++) {
+            std::fprintf(trace_file, ",%s_us", METRIC_NAMES[i]);
+        }
+        std::fprintf(trace_file, ",gpu_start_us\n");
+    } else {
+        std::fprintf(trace_file, "{\"traceEvents\":[\n");
+    }
+    return true;
+}
+
+void AynThorFrameStats::stop_trace() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!trace_file) return;
+    if (trace_format == TRACE_CHROME) {
+        std::fprintf(trace_file, "\n]}\n");
+    }
+    std::fclose(trace_file);
+    trace_file = nullptr;
+}
+
+bool AynThorFrameStats::is_tracing() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return trace_file != nullptr;
+}
+
+void AynThorFrameStats::_write_trace(const FrameTiming& p_timing) {
+    if (trace_origin_ns == 0) trace_origin_ns = p_timing.start_ns;
+    uint64_t frame = trace_frame++;
+
+    if (trace_format == TRACE_CSV) {
+        std::fprintf(trace_file, "%llu,%.3f", (unsigned long long)frame, (double)(p_timing.start_ns - trace_origin_ns) / 1000.0);
+        for (int i = 0; i < METRIC_MAX; i++) {
+            if (p_timing.usec[i] >= 0.0) {
+                std::fprintf(trace_file, ",%.3f", p_timing.usec[i]);
+            } else {
+                std::fprintf(trace_file, ",");
+            }
+        }
+        if (p_timing.usec[METRIC_GPU_COPY] >= 0.0 && p_timing.gpu_start_ns >= trace_origin_ns) {
+            std::fprintf(trace_file, ",%.3f\n", (double)(p_timing.gpu_start_ns - trace_origin_ns) / 1000.0);
+        } else {
+            std::fprintf(trace_file, ",\n");
+        }
+        return;
+    }
+
+    // The CPU phases run back to back from the start of the frame.
+    uint64_t phase_start = p_timing.start_ns;
+    for (int i = METRIC_FENCE_WAIT; i <= METRIC_PRESENT; i++) {
+        _write_chrome_event(METRIC_NAMES[i], 1, phase_start, p_timing.usec[i]);
+        phase_start += (uint64_t)(p_timing.usec[i] * 1000.0);
+    }
+    // GPU timestamps are not calibrated against the CPU clock, so the copy
+    // is placed at the start of the frame it belongs to.
+    if (p_timing.usec[METRIC_GPU_COPY] >= 0.0 && p_timing.gpu_start_ns >= trace_origin_ns) {
+        _write_chrome_event(METRIC_NAMES[METRIC_GPU_COPY], 2, p_timing.gpu_start_ns, p_timing.usec[METRIC_GPU_COPY]);
+    }
+}
+
+void AynThorFrameStats::_write_chrome_event(const char* p_name, int p_thread, uint64_t p_start_ns, double p_duration_usec) {
+    std::fprintf(trace_file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+            trace_first_event ? "" : ",\n", p_name, p_thread, (double)(p_start_ns - trace_origin_ns) / 1000.0, p_duration_usec);
+    trace_first_event = false;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef AYN_THOR_FRAME_STATS_H
+#define AYN_THOR_FRAME_STATS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace godot {
+
+// Rolling per-phase timings of the present path. Written by whichever thread
+// presents, read from the main thread; percentiles are computed on demand
+// over the last WINDOW samples and cached until the next frame lands.
+class AynThorFrameStats {
+public:
+    enum Metric {
+        METRIC_FENCE_WAIT,
+        METRIC_ACQUIRE,
+        METRIC_RECORD,
+        METRIC_SUBMIT,
+        METRIC_PRESENT,
+        METRIC_CPU_TOTAL,
+        METRIC_GPU_COPY,
+        METRIC_MAX,
+    };
+
+    enum TraceFormat {
+        TRACE_CSV,
+        TRACE_CHROME,
+    };
+
+    static const uint32_t WINDOW = 240;
+
+    struct Percentiles {
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        uint32_t count = 0;
+    };
+
+    // One present, in microseconds. The GPU time belongs to the earlier
+    // frame that started at gpu_start_ns, since timestamps are only read
+    // once that frame's slot comes around again; a negative value means no
+    // result was available.
+    struct FrameTiming {
+        uint64_t start_ns = 0;
+        double usec[METRIC_MAX] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, -1.0};
+        uint64_t gpu_start_ns = 0;
+    };
+
+    ~AynThorFrameStats();
+
+    static const char* get_metric_name(Metric p_metric);
+
+    void record(const FrameTiming& p_timing);
+    Percentiles get_percentiles(Metric p_metric);
+    void reset();
+
+    // Streams every recorded frame to p_path until stop_trace().
+    bool start_trace(const std::string& p_path, TraceFormat p_format);
+    void stop_trace();
+    bool is_tracing() const;
+
+private:
+    struct Window {
+        double samples[WINDOW];
+        uint32_t count = 0;
+        uint32_t next = 0;
+        bool cached = false;
+        Percentiles percentiles;
+    };
+
+    mutable std::mutex mutex;
+    Window windows[METRIC_MAX];
+    std::vector<double> scratch;
+
+    FILE* trace_file = nullptr;
+    TraceFormat trace_format = TRACE_CSV;
+    uint64_t trace_origin_ns = 0;
+    uint64_t trace_frame = 0;
+    bool trace_first_event = true;
+
+    void _push(Metric p_metric, double p_usec);
+    void _write_trace(const FrameTiming& p_timing);
+    void _write_chrome_event(const char* p_name, int p_thread, uint64_t p_start_ns, double p_duration_usec);
+};
+
+}
+
+#endif
\ No newline at end of file
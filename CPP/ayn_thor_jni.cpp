@@ -5,36 +5,64 @@
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 #include <android/window.h>
-#include <mutex>
+#include "ayn_thor_display_registry.h"
 
-ANativeWindow* g_second_window = nullptr;
-std::mutex g_window_mutex;
+using godot::AynThorDisplayRegistry;
 
 extern "C" {
 
-    JNIEXPORT void JNICALL Java_org_godot_plugins_aynthor_AynThorPlugin_nativeSetSurface(JNIEnv* env, jobject clazz, jobject surface) {
-        std::lock_guard<std::mutex> lock(g_window_mutex);
-        if (g_second_window) {
-            ANativeWindow_release(g_second_window);
+    JNIEXPORT void JNICALL Java_org_godot_plugins_aynthor_AynThorPlugin_nativeSetSurface(JNIEnv* env, jobject clazz, jint display_id, jobject surface) {
+        ANativeWindow* window = ANativeWindow_fromSurface(env, surface);
+        int32_t width = 0;
+        int32_t height = 0;
+
+        if (window) {
+            ANativeWindow_setBuffersGeometry(window, 0, 0, WINDOW_FORMAT_RGBA_8888);
+            width = ANativeWindow_getWidth(window);
+            height = ANativeWindow_getHeight(window);
         }
 
-        g_second_window = ANativeWindow_fromSurface(env, surface);
+        AynThorDisplayRegistry::get_singleton()->set_window(display_id, window, width, height);
+    }
 
-        if (g_second_window) {
-            ANativeWindow_setBuffersGeometry(g_second_window, 0, 0, WINDOW_FORMAT_RGBA_8888);
-        }
+    JNIEXPORT void JNICALL Java_org_godot_plugins_aynthor_AynThorPlugin_nativeSurfaceChanged(JNIEnv* env, jobject clazz, jint display_id, jint width, jint height) {
+        AynThorDisplayRegistry::get_singleton()->surface_changed(display_id, width, height);
+    }
+
+    JNIEXPORT void JNICALL Java_org_godot_plugins_aynthor_AynThorPlugin_nativeSetRefreshRate(JNIEnv* env, jobject clazz, jint display_id, jfloat refresh_rate) {
+        AynThorDisplayRegistry::get_singleton()->set_refresh_rate(display_id, refresh_rate);
     }
 
-    JNIEXPORT void JNICALL Java_org_godot_plugins_aynthor_AynThorPlugin_nativeRemoveSurface(JNIEnv* env, jobject clazz) {
-        std::lock_guard<std::mutex> lock(g_window_mutex);
-        if (g_second_window) {
-            ANativeWindow_release(g_second_window);
-            g_second_window = nullptr;
+    JNIEXPORT void JNICALL Java_org_godot_plugins_aynthor_AynThorPlugin_nativePushTouches(JNIEnv* env, jobject clazz, jint display_id, jint count, jintArray actions, jintArray pointer_ids, jfloatArray coords, jlongArray times) {
+        if (count <= 0) return;
+        AynThorDisplayRegistry::Display* display = AynThorDisplayRegistry::get_singleton()->find(display_id);
+        if (!display) return;
+
+        jint* action_data = (jint*)env->GetPrimitiveArrayCritical(actions, nullptr);
+        jint* id_data = (jint*)env->GetPrimitiveArrayCritical(pointer_ids, nullptr);
+        jfloat* coord_data = (jfloat*)env->GetPrimitiveArrayCritical(coords, nullptr);
+        jlong* time_data = (jlong*)env->GetPrimitiveArrayCritical(times, nullptr);
+
+        if (action_data && id_data && coord_data && time_data) {
+            for (jint i = 0; i < count; i++) {
+                godot::TouchSample sample;
+                sample.action = action_data[i];
+                sample.pointer_id = id_data[i];
+                sample.x = coord_data[i * 2];
+                sample.y = coord_data[i * 2 + 1];
+                sample.time_ns = time_data[i];
+                display->touch_ring.push(sample);
+            }
         }
+
+        if (time_data) env->ReleasePrimitiveArrayCritical(times, time_data, JNI_ABORT);
+        if (coord_data) env->ReleasePrimitiveArrayCritical(coords, coord_data, JNI_ABORT);
+        if (id_data) env->ReleasePrimitiveArrayCritical(pointer_ids, id_data, JNI_ABORT);
+        if (action_data) env->ReleasePrimitiveArrayCritical(actions, action_data, JNI_ABORT);
+    }
+
+    JNIEXPORT void JNICALL Java_org_godot_plugins_aynthor_AynThorPlugin_nativeRemoveSurface(JNIEnv* env, jobject clazz, jint display_id) {
+        AynThorDisplayRegistry::get_singleton()->remove_window(display_id);
     }
 }
-#else
-#include <mutex>
-void* g_second_window = nullptr;
-std::mutex g_window_mutex;
 #endif
\ No newline at end of file
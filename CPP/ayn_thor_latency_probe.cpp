@@ -0,0 +1,100 @@
+#include "ayn_thor_latency_probe.h"
+#include <algorithm>
+#include <cmath>
+
+namespace godot {
+
+void AynThorLatencyProbe::touched(uint64_t p_frame, int64_t p_time_ns) {
+    if (p_time_ns <= 0) return;
+    if (frame_touch_count > 0 && frame_touches[frame_touch_count - 1].frame == p_frame) {
+        FrameTouch &last = frame_touches[frame_touch_count - 1];
+        last.time_ns = std::min(last.time_ns, p_time_ns);
+        return;
+    }
+    if (frame_touch_count == TOUCH_FRAMES) {
+        // Nothing has been presented for a while; fold the two newest frames
+        // so the oldest touch is kept.
+        FrameTouch &last = frame_touches[TOUCH_FRAMES - 1];
+        last.frame = p_frame;
+        last.time_ns = std::min(last.time_ns, p_time_ns);
+        return;
+    }
+    frame_touches[frame_touch_count].frame = p_frame;
+    frame_touches[frame_touch_count].time_ns = p_time_ns;
+    frame_touch_count++;
+}
+
+int64_t AynThorLatencyProbe::take_reflected(uint64_t p_frame) {
+    int64_t oldest = 0;
+    uint32_t taken = 0;
+    while (taken < frame_touch_count && frame_touches[taken].frame <= p_frame) {
+        int64_t time_ns = frame_touches[taken].time_ns;
+        oldest = oldest == 0 ? time_ns : std::min(oldest, time_ns);
+        taken++;
+    }
+    if (taken == 0) return 0;
+    for (uint32_t i = taken; i < frame_touch_count; i++) {
+        frame_touches[i - taken] = frame_touches[i];
+    }
+    frame_touch_count -= taken;
+    return oldest;
+}
+
+void AynThorLatencyProbe::submitted(uint64_t p_present_id, int64_t p_touch_ns) {
+    // A present that never gets reported is overwritten once the ring wraps.
+    InFlight &entry = in_flight[in_flight_next];
+    entry.present_id = p_present_id;
+    entry.touch_ns = p_touch_ns;
+    in_flight_next = (in_flight_next + 1) % IN_FLIGHT;
+}
+
+void AynThorLatencyProbe::presented(uint64_t p_present_id, uint64_t p_time_ns, Source p_source) {
+    bool short_id = p_source == SOURCE_DISPLAY_TIMING;
+    for (InFlight &entry : in_flight) {
+        if (entry.touch_ns == 0) continue;
+        bool match = short_id ? (uint32_t)entry.present_id == (uint32_t)p_present_id : entry.present_id == p_present_id;
+        if (!match) continue;
+
+        int64_t latency_ns = (int64_t)p_time_ns - entry.touch_ns;
+        entry.touch_ns = 0;
+        if (latency_ns < 0) return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        samples[next] = (double)latency_ns / 1000.0;
+        next = (next + 1) % WINDOW;
+        if (count < WINDOW) count++;
+        source = p_source;
+        return;
+    }
+}
+
+AynThorLatencyProbe::Distribution AynThorLatencyProbe::get_distribution() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Distribution result;
+    result.count = count;
+    result.source = source;
+    if (count == 0) return result;
+
+    scratch.assign(samples, samples + count);
+    std::sort(scratch.begin(), scratch.end());
+    // Nearest-rank, like AynThorFrameStats.
+    auto rank = [this](double p_fraction) {
+        size_t index = (size_t)std::ceil(p_fraction * (double)scratch.size());
+        return scratch[index > 0 ? index - 1 : 0];
+    };
+    result.p50 = rank(0.50);
+    result.p95 = rank(0.95);
+    result.p99 = rank(0.99);
+    result.min = scratch.front();
+    result.max = scratch.back();
+    return result;
+}
+
+void AynThorLatencyProbe::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    count = 0;
+    next = 0;
+    source = SOURCE_NONE;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef AYN_THOR_LATENCY_PROBE_H
+#define AYN_THOR_LATENCY_PROBE_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace godot {
+
+// Touch-to-present latency of the second screen. The main thread notes in
+// which engine frame touches reached the viewport and hands the oldest one a
+// render reflects to the frame that presents it; the present path pairs that
+// touch with the time the frame reached the panel. All times are
+// CLOCK_MONOTONIC, the clock MotionEvent times are taken from.
+class AynThorLatencyProbe {
+public:
+    enum Source {
+        SOURCE_NONE,
+        // actualPresentTime from VK_GOOGLE_display_timing.
+        SOURCE_DISPLAY_TIMING,
+        // vkWaitForPresentKHR returning for the frame's present id.
+        SOURCE_PRESENT_WAIT,
+        // The time of the poll, at the next acquire after the slot's fence
+        // wait, that first saw the frame's fence signaled. The copy was done
+        // by then, but not necessarily shown, and it may have been done
+        // well before.
+        SOURCE_FENCE,
+    };
+
+    static const uint32_t WINDOW = 240;
+
+    // In microseconds over the last WINDOW samples.
+    struct Distribution {
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        uint32_t count = 0;
+        Source source = SOURCE_NONE;
+    };
+
+    // Main thread. Touches handed to the viewport during engine frame p_frame.
+    void touched(uint64_t p_frame, int64_t p_time_ns);
+    // Oldest touch that a render at the end of p_frame reflects and no
+    // earlier one did, or 0. Consumes every touch up to that frame.
+    int64_t take_reflected(uint64_t p_frame);
+
+    // Present path. A present carrying a touch, then the time it was shown;
+    // display timing only reports the low 32 bits of the id.
+    void submitted(uint64_t p_present_id, int64_t p_touch_ns);
+    void presented(uint64_t p_present_id, uint64_t p_time_ns, Source p_source);
+
+    Distribution get_distribution();
+    void reset();
+
+private:
+    static const uint32_t TOUCH_FRAMES = 8;
+    static const uint32_t IN_FLIGHT = 16;
+
+    struct FrameTouch {
+        uint64_t frame = 0;
+        int64_t time_ns = 0;
+    };
+    struct InFlight {
+        uint64_t present_id = 0;
+        int64_t touch_ns = 0;
+    };
+
+    // Oldest touch of each engine frame that had any, in frame order.
+    FrameTouch frame_touches[TOUCH_FRAMES];
+    uint32_t frame_touch_count = 0;
+
+    InFlight in_flight[IN_FLIGHT];
+    uint32_t in_flight_next = 0;
+
+    std::mutex mutex;
+    double samples[WINDOW];
+    uint32_t count = 0;
+    uint32_t next = 0;
+    Source source = SOURCE_NONE;
+    std::vector<double> scratch;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include "ayn_thor_present_ring.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace godot {
+
+#ifdef AYN_THOR_VULKAN
+static uint64_t _monotonic_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void AynThorPresentRing::init(VkPhysicalDevice p_physical_device, VkDevice p_device) {
+    physical_device = p_physical_device;
+    device = p_device;
+}
+
+bool AynThorPresentRing::create_timestamps(uint32_t p_queue_family_index) {
+    destroy_timestamps();
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    if (familyCount > 0) {
+        vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &familyCount, families.data());
+    }
+    if (p_queue_family_index >= familyCount || families[p_queue_family_index].timestampValidBits == 0) return false;
+
+    uint32_t valid_bits = families[p_queue_family_index].timestampValidBits;
+    timestamp_mask = valid_bits >= 64 ? UINT64_MAX : (((uint64_t)1 << valid_bits) - 1);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    timestamp_period_ns = (double)properties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo queryInfo = {};
+    queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryInfo.queryCount = MAX_SLOTS * 2;
+    if (vkCreateQueryPool(device, &queryInfo, nullptr, &timestamp_pool) != VK_SUCCESS) {
+        timestamp_pool = VK_NULL_HANDLE;
+        return false;
+    }
+    return true;
+}
+
+void AynThorPresentRing::destroy_timestamps() {
+    if (timestamp_pool) vkDestroyQueryPool(device, timestamp_pool, nullptr);
+    timestamp_pool = VK_NULL_HANDLE;
+    for (Slot &slot : slots) slot.timestamps_written = false;
+}
+
+bool AynThorPresentRing::create_slots(VkCommandPool p_command_pool, uint32_t p_count) {
+    command_pool = p_command_pool;
+    slots.resize(std::min(std::max(p_count, 1u), MAX_SLOTS));
+    current = 0;
+
+    std::vector<VkCommandBuffer> command_buffers(slots.size());
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = command_pool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = (uint32_t)command_buffers.size();
+    if (vkAllocateCommandBuffers(device, &allocInfo, command_buffers.data()) != VK_SUCCESS) {
+        slots.clear();
+        return false;
+    }
+
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    for (size_t i = 0; i < slots.size(); i++) {
+        Slot &slot = slots[i];
+        slot.command_buffer = command_buffers[i];
+        if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &slot.image_available_semaphore) != VK_SUCCESS ||
+                vkCreateSemaphore(device, &semaphoreInfo, nullptr, &slot.render_finished_semaphore) != VK_SUCCESS ||
+                vkCreateFence(device, &fenceInfo, nullptr, &slot.in_flight_fence) != VK_SUCCESS) {
+            destroy_slots();
+            return false;
+        }
+    }
+    return true;
+}
+
+void AynThorPresentRing::destroy_slots() {
+    wait_slots(UINT64_MAX);
+    for (Slot &slot : slots) {
+        if (slot.image_available_semaphore) vkDestroySemaphore(device, slot.image_available_semaphore, nullptr);
+        if (slot.render_finished_semaphore) vkDestroySemaphore(device, slot.render_finished_semaphore, nullptr);
+        if (slot.in_flight_fence) vkDestroyFence(device, slot.in_flight_fence, nullptr);
+        if (slot.command_buffer) vkFreeCommandBuffers(device, command_pool, 1, &slot.command_buffer);
+    }
+    slots.clear();
+    current = 0;
+    forget_images();
+}
+
+void AynThorPresentRing::wait_slots(uint64_t p_timeout_ns) {
+    std::vector<VkFence> fences;
+    for (const Slot &slot : slots) {
+        if (slot.in_flight_fence) fences.push_back(slot.in_flight_fence);
+    }
+    if (!fences.empty()) {
+        vkWaitForFences(device, (uint32_t)fences.size(), fences.data(), VK_TRUE, p_timeout_ns);
+    }
+}
+
+void AynThorPresentRing::swapchain_created(VkSurfaceKHR p_surface, uint32_t p_image_count, const VkSurfaceCapabilitiesKHR& p_capabilities) {
+    surface = p_surface;
+    surface_transform = p_capabilities.currentTransform;
+    surface_extent = p_capabilities.currentExtent;
+    images_in_flight.assign(p_image_count, VK_NULL_HANDLE);
+}
+
+void AynThorPresentRing::retire_swapchain(VkSwapchainKHR p_swapchain) {
+    if (p_swapchain) retired_swapchains.push_back(p_swapchain);
+}
+
+void AynThorPresentRing::destroy_retired_swapchains() {
+    for (VkSwapchainKHR retired : retired_swapchains) {
+        vkDestroySwapchainKHR(device, retired, nullptr);
+    }
+    retired_swapchains.clear();
+}
+
+void AynThorPresentRing::forget_images() {
+    std::fill(images_in_flight.begin(), images_in_flight.end(), VK_NULL_HANDLE);
+}
+
+void AynThorPresentRing::wait_slot(AynThorFrameStats::FrameTiming& r_timing) {
+    Slot &slot = slots[current];
+    r_timing.start_ns = _monotonic_ns();
+
+    // Only blocks when every slot of the ring is still queued on the GPU.
+    vkWaitForFences(device, 1, &slot.in_flight_fence, VK_TRUE, UINT64_MAX);
+    r_timing.usec[AynThorFrameStats::METRIC_GPU_COPY] = -1.0;
+    if (!timestamp_pool || !slot.timestamps_written) return;
+    slot.timestamps_written = false;
+
+    // The fence has signaled, so the results are available and this never
+    // stalls.
+    uint64_t timestamps[2] = {};
+    if (vkGetQueryPoolResults(device, timestamp_pool, current * 2, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) return;
+    r_timing.gpu_start_ns = slot.start_ns;
+    uint64_t ticks = (timestamps[1] - timestamps[0]) & timestamp_mask;
+    r_timing.usec[AynThorFrameStats::METRIC_GPU_COPY] = (double)ticks * timestamp_period_ns / 1000.0;
+}
+
+AynThorPresentRing::Result AynThorPresentRing::acquire(VkSwapchainKHR p_swapchain, uint64_t p_timeout_ns, AynThorFrameStats::FrameTiming& r_timing, uint32_t& r_image_index) {
+    Slot &slot = slots[current];
+    uint64_t acquire_start = _monotonic_ns();
+    VkResult res = vkAcquireNextImageKHR(device, p_swapchain, p_timeout_ns, slot.image_available_semaphore, VK_NULL_HANDLE, &r_image_index);
+    uint64_t acquire_end = _monotonic_ns();
+
+    if (res == VK_ERROR_OUT_OF_DATE_KHR) {
+        return RESULT_OUT_OF_DATE;
+    } else if (res == VK_ERROR_SURFACE_LOST_KHR) {
+        return RESULT_SURFACE_LOST;
+    } else if (res == VK_TIMEOUT || res == VK_NOT_READY) {
+        return RESULT_TIMEOUT;
+    } else if (res != VK_SUCCESS && res != VK_SUBOPTIMAL_KHR) {
+        return RESULT_FAILED;
+    }
+
+    // An image the new swapchain already presented only comes back once a
+    // later present replaced it on screen, so everything the retired
+    // swapchains presented before has been shown and released by then.
+    if (!retired_swapchains.empty() && images_in_flight[r_image_index] != VK_NULL_HANDLE) {
+        destroy_retired_swapchains();
+    }
+
+    // The swapchain may hand back an image that an older slot is still writing.
+    VkFence image_fence = images_in_flight[r_image_index];
+    if (image_fence != VK_NULL_HANDLE && image_fence != slot.in_flight_fence) {
+        vkWaitForFences(device, 1, &image_fence, VK_TRUE, UINT64_MAX);
+    }
+    images_in_flight[r_image_index] = slot.in_flight_fence;
+    uint64_t wait_end = _monotonic_ns();
+    // Fence waits on either side of the acquire both count as waiting.
+    r_timing.usec[AynThorFrameStats::METRIC_FENCE_WAIT] = (double)((acquire_start - r_timing.start_ns) + (wait_end - acquire_end)) / 1000.0;
+    r_timing.usec[AynThorFrameStats::METRIC_ACQUIRE] = (double)(acquire_end - acquire_start) / 1000.0;
+    return RESULT_OK;
+}
+
+void AynThorPresentRing::write_start_timestamp(VkCommandBuffer p_command_buffer) {
+    if (!timestamp_pool) return;
+    // Written at the stage the acquire semaphore gates, so the span leaves
+    // out the wait for the swapchain image.
+    vkCmdResetQueryPool(p_command_buffer, timestamp_pool, current * 2, 2);
+    vkCmdWriteTimestamp(p_command_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, timestamp_pool, current * 2);
+}
+
+void AynThorPresentRing::write_end_timestamp(VkCommandBuffer p_command_buffer) {
+    if (!timestamp_pool) return;
+    vkCmdWriteTimestamp(p_command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestamp_pool, current * 2 + 1);
+}
+
+VkFence AynThorPresentRing::begin_submit() {
+    VkFence fence = slots[current].in_flight_fence;
+    vkResetFences(device, 1, &fence);
+    return fence;
+}
+
+void AynThorPresentRing::end_submit(bool p_timestamps, uint64_t p_start_ns) {
+    Slot &slot = slots[current];
+    slot.timestamps_written = p_timestamps && timestamp_pool != VK_NULL_HANDLE;
+    slot.start_ns = p_start_ns;
+    current = (current + 1) % (uint32_t)slots.size();
+}
+
+AynThorPresentRing::Result AynThorPresentRing::present(VkQueue p_queue, const VkPresentInfoKHR& p_present_info, uint64_t p_submit_start_ns, AynThorFrameStats::FrameTiming& r_timing) {
+    uint64_t present_start = _monotonic_ns();
+    r_timing.usec[AynThorFrameStats::METRIC_SUBMIT] = (double)(present_start - p_submit_start_ns) / 1000.0;
+    VkResult res = vkQueuePresentKHR(p_queue, &p_present_info);
+    uint64_t present_end = _monotonic_ns();
+    r_timing.usec[AynThorFrameStats::METRIC_PRESENT] = (double)(present_end - present_start) / 1000.0;
+    r_timing.usec[AynThorFrameStats::METRIC_CPU_TOTAL] = (double)(present_end - r_timing.start_ns) / 1000.0;
+
+    if (res == VK_SUCCESS) {
+        return RESULT_OK;
+    } else if (res == VK_SUBOPTIMAL_KHR) {
+        return surface_changed() ? RESULT_SUBOPTIMAL : RESULT_OK;
+    } else if (res == VK_ERROR_OUT_OF_DATE_KHR) {
+        return RESULT_OUT_OF_DATE;
+    } else if (res == VK_ERROR_SURFACE_LOST_KHR) {
+        return RESULT_SURFACE_LOST;
+    }
+    return RESULT_FAILED;
+}
+
+bool AynThorPresentRing::surface_changed() const {
+    VkSurfaceCapabilitiesKHR capabilities;
+    if (vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physical_device, surface, &capabilities) != VK_SUCCESS) return true;
+    return capabilities.currentTransform != surface_transform || capabilities.currentExtent.width != surface_extent.width ||
+            capabilities.currentExtent.height != surface_extent.height;
+}
+#endif
+
+}
@@ -0,0 +1,115 @@
+#ifndef AYN_THOR_PRESENT_RING_H
+#define AYN_THOR_PRESENT_RING_H
+
+#include "ayn_thor_blit.h"
+#include "ayn_thor_frame_stats.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace godot {
+
+// The frame ring of the present path: per-slot fences and semaphores, the
+// fence wait, acquire and present with their timing, GPU timestamps around
+// the copy, and the swapchains a rebuild retired. It has no dependency on
+// Godot, so the renderer and the headless benchmark run the same code; the
+// renderer adds its own submit batches, present chain and threads on top.
+//
+// A frame is wait_slot(), acquire(), recording the copy between
+// write_start_timestamp() and write_end_timestamp(), a submit signalling
+// begin_submit()'s fence, end_submit(), then present().
+class AynThorPresentRing {
+public:
+    static constexpr uint32_t MAX_SLOTS = 4;
+
+    enum Result {
+        RESULT_OK,
+        RESULT_TIMEOUT,
+        RESULT_FAILED,
+        RESULT_SURFACE_LOST,
+        // Nothing was acquired or shown; rebuild the swapchain first.
+        RESULT_OUT_OF_DATE,
+        // Shown, but the surface changed since the swapchain was created;
+        // rebuild it before the next acquire.
+        RESULT_SUBOPTIMAL,
+    };
+
+#ifdef AYN_THOR_VULKAN
+    struct Slot {
+        VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+        VkSemaphore image_available_semaphore = VK_NULL_HANDLE;
+        VkSemaphore render_finished_semaphore = VK_NULL_HANDLE;
+        VkFence in_flight_fence = VK_NULL_HANDLE;
+        // Set once the slot's copy wrote its timestamp pair, cleared when read.
+        bool timestamps_written = false;
+        uint64_t start_ns = 0;
+    };
+
+    void init(VkPhysicalDevice p_physical_device, VkDevice p_device);
+
+    // Two timestamps per slot, counted on the family the copy runs on.
+    // False when that family has no timestamp support.
+    bool create_timestamps(uint32_t p_queue_family_index);
+    void destroy_timestamps();
+    bool has_timestamps() const { return timestamp_pool != VK_NULL_HANDLE; }
+
+    bool create_slots(VkCommandPool p_command_pool, uint32_t p_count);
+    // Waits for the slots first.
+    void destroy_slots();
+    void wait_slots(uint64_t p_timeout_ns);
+
+    uint32_t get_slot_count() const { return (uint32_t)slots.size(); }
+    uint32_t get_current_index() const { return current; }
+    Slot& get_slot(uint32_t p_index) { return slots[p_index]; }
+    Slot& get_current() { return slots[current]; }
+
+    // After every swapchain creation, with the surface capabilities it was
+    // created from.
+    void swapchain_created(VkSurfaceKHR p_surface, uint32_t p_image_count, const VkSurfaceCapabilitiesKHR& p_capabilities);
+    // Keeps a replaced swapchain until its presents are known to be done,
+    // see acquire().
+    void retire_swapchain(VkSwapchainKHR p_swapchain);
+    void destroy_retired_swapchains();
+    // No image is being written by any slot any more.
+    void forget_images();
+
+    // Blocks until the current slot's previous copy is done and reports its
+    // GPU time; r_timing.start_ns is taken here.
+    void wait_slot(AynThorFrameStats::FrameTiming& r_timing);
+    Result acquire(VkSwapchainKHR p_swapchain, uint64_t p_timeout_ns, AynThorFrameStats::FrameTiming& r_timing, uint32_t& r_image_index);
+    void write_start_timestamp(VkCommandBuffer p_command_buffer);
+    void write_end_timestamp(VkCommandBuffer p_command_buffer);
+    // Resets and returns the current slot's fence; the frame's last submit
+    // has to signal it.
+    VkFence begin_submit();
+    // The current slot's work is queued; moves on to the next slot.
+    void end_submit(bool p_timestamps, uint64_t p_start_ns);
+    // Android reports SUBOPTIMAL for every present whose pre-transform is
+    // not the surface's current one, so only a change since creation counts.
+    Result present(VkQueue p_queue, const VkPresentInfoKHR& p_present_info, uint64_t p_submit_start_ns, AynThorFrameStats::FrameTiming& r_timing);
+    bool surface_changed() const;
+
+private:
+    VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkCommandPool command_pool = VK_NULL_HANDLE;
+
+    std::vector<Slot> slots;
+    uint32_t current = 0;
+
+    VkQueryPool timestamp_pool = VK_NULL_HANDLE;
+    double timestamp_period_ns = 0.0;
+    uint64_t timestamp_mask = 0;
+
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+    VkSurfaceTransformFlagBitsKHR surface_transform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+    VkExtent2D surface_extent = {0, 0};
+    // Fence of the slot that last wrote each swapchain image (not owned).
+    std::vector<VkFence> images_in_flight;
+    std::vector<VkSwapchainKHR> retired_swapchains;
+#endif
+};
+
+}
+
+#endif
@@ -1,140 +1,1615 @@
 #include "ayn_thor_renderer.h"
 #include <godot_cpp/variant/utility_functions.hpp>
 #include <godot_cpp/classes/rd_texture_format.hpp>
-#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/rd_shader_source.hpp>
+#include <godot_cpp/classes/rd_shader_spirv.hpp>
+#include <godot_cpp/classes/input_event_screen_touch.hpp>
+#include <godot_cpp/classes/input_event_screen_drag.hpp>
+#include <godot_cpp/classes/performance.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/camera3d.hpp>
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/sub_viewport.hpp>
+#include <godot_cpp/classes/xr_server.hpp>
+#include <godot_cpp/core/object.hpp>
+#include <godot_cpp/variant/callable_method_pointer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
 #include <mutex>
 
 #ifdef __ANDROID__
 #include <android/native_window.h>
-extern ANativeWindow* g_second_window;
-extern std::mutex g_window_mutex;
-#else
-extern void* g_second_window;
-extern std::mutex g_window_mutex;
 #endif
 
 namespace godot {
 
+static const char* PIPELINE_CACHE_PATH = "user://aynthor_pipeline_cache.bin";
+
+// MotionEvent action codes as sent by the plugin.
+enum {
+    TOUCH_ACTION_DOWN = 0,
+    TOUCH_ACTION_UP = 1,
+    TOUCH_ACTION_MOVE = 2,
+    TOUCH_ACTION_CANCEL = 3,
+    TOUCH_ACTION_POINTER_DOWN = 5,
+    TOUCH_ACTION_POINTER_UP = 6,
+};
+
+// Performance monitors: p50/p95/p99 of every metric, then the counters.
+static const char* MONITOR_PERCENTILES[3] = {"p50", "p95", "p99"};
+enum {
+    MONITOR_SWAPCHAIN_RECREATIONS = AynThorFrameStats::METRIC_MAX * 3,
+    MONITOR_SKIPPED_FRAMES,
+    MONITOR_DROPPED_FRAMES,
+    MONITOR_LATE_FRAMES,
+    MONITOR_MAX,
+};
+
+static String _monitor_name(int p_index) {
+    if (p_index < MONITOR_SWAPCHAIN_RECREATIONS) {
+        return String(AynThorFrameStats::get_metric_name((AynThorFrameStats::Metric)(p_index / 3))) + "_" + MONITOR_PERCENTILES[p_index % 3] + "_usec";
+    }
+    switch (p_index) {
+        case MONITOR_SWAPCHAIN_RECREATIONS: return "swapchain_recreations";
+        case MONITOR_SKIPPED_FRAMES: return "skipped_frames";
+        case MONITOR_DROPPED_FRAMES: return "dropped_frames";
+        default: return "late_frames";
+    }
+}
+
+#ifdef __ANDROID__
+static VkSurfaceTransformFlagBitsKHR _transform_for_degrees(int p_degrees) {
+    switch (p_degrees) {
+        case 90: return VK_SURFACE_TRANSFORM_ROTATE_90_BIT_KHR;
+        case 180: return VK_SURFACE_TRANSFORM_ROTATE_180_BIT_KHR;
+        case 270: return VK_SURFACE_TRANSFORM_ROTATE_270_BIT_KHR;
+        default: return VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+    }
+}
+
+// -1 for the mirrored transforms.
+static int _degrees_for_transform(VkSurfaceTransformFlagBitsKHR p_transform) {
+    switch (p_transform) {
+        case VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR: return 0;
+        case VK_SURFACE_TRANSFORM_ROTATE_90_BIT_KHR: return 90;
+        case VK_SURFACE_TRANSFORM_ROTATE_180_BIT_KHR: return 180;
+        case VK_SURFACE_TRANSFORM_ROTATE_270_BIT_KHR: return 270;
+        default: return -1;
+    }
+}
+
+static uint32_t _format_bytes_per_pixel(VkFormat p_format) {
+    switch (p_format) {
+        case VK_FORMAT_R5G6B5_UNORM_PACK16:
+        case VK_FORMAT_B5G6R5_UNORM_PACK16: return 2;
+        case VK_FORMAT_R16G16B16A16_SFLOAT: return 8;
+        default: return 4;
+    }
+}
+
+// Formats Godot renders viewports in; anything else is counted as 4 bytes.
+static uint32_t _data_format_bytes_per_pixel(RenderingDevice::DataFormat p_format) {
+    switch (p_format) {
+        case RenderingDevice::DATA_FORMAT_R5G6B5_UNORM_PACK16:
+        case RenderingDevice::DATA_FORMAT_B5G6R5_UNORM_PACK16: return 2;
+        case RenderingDevice::DATA_FORMAT_R16G16B16A16_UNORM:
+        case RenderingDevice::DATA_FORMAT_R16G16B16A16_SFLOAT: return 8;
+        case RenderingDevice::DATA_FORMAT_R32G32B32A32_SFLOAT: return 16;
+        default: return 4;
+    }
+}
+
+// Renderers on the same device submit to the same queue; each VkQueue gets
+// one lock that lives as long as the process.
+static std::mutex& _shared_queue_mutex(VkQueue p_queue) {
+    static std::mutex registry_mutex;
+    static std::map<VkQueue, std::unique_ptr<std::mutex>> queue_mutexes;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::unique_ptr<std::mutex>& queue_mutex = queue_mutexes[p_queue];
+    if (!queue_mutex) queue_mutex.reset(new std::mutex);
+    return *queue_mutex;
+}
+
+static const char* _format_name(int p_format) {
+    switch (p_format) {
+        case VK_FORMAT_R8G8B8A8_UNORM: return "R8G8B8A8_UNORM";
+        case VK_FORMAT_B8G8R8A8_UNORM: return "B8G8R8A8_UNORM";
+        case VK_FORMAT_R5G6B5_UNORM_PACK16: return "R5G6B5_UNORM";
+        case VK_FORMAT_B5G6R5_UNORM_PACK16: return "B5G6R5_UNORM";
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32: return "A2B10G10R10_UNORM";
+        case VK_FORMAT_A2R10G10B10_UNORM_PACK32: return "A2R10G10B10_UNORM";
+        case VK_FORMAT_R16G16B16A16_SFLOAT: return "R16G16B16A16_SFLOAT";
+        case VK_FORMAT_UNDEFINED: return "";
+        default: return "other";
+    }
+}
+#endif
+
+// CLOCK_MONOTONIC on Android, the clock VK_GOOGLE_display_timing reports in.
+static uint64_t _monotonic_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 void AynThorRenderer::_bind_methods() {
     ClassDB::bind_method(D_METHOD("is_window_available"), &AynThorRenderer::is_window_available);
+    ClassDB::bind_method(D_METHOD("is_output_ready"), &AynThorRenderer::is_output_ready);
     ClassDB::bind_method(D_METHOD("draw_viewport_texture", "texture_rid"), &AynThorRenderer::draw_viewport_texture);
+    ClassDB::bind_method(D_METHOD("draw_viewport_direct", "viewport"), &AynThorRenderer::draw_viewport_direct);
     ClassDB::bind_method(D_METHOD("fill_color", "r", "g", "b"), &AynThorRenderer::fill_color);
     ClassDB::bind_method(D_METHOD("get_second_screen_size"), &AynThorRenderer::get_second_screen_size);
+    ClassDB::bind_method(D_METHOD("flush_touch_input", "viewport"), &AynThorRenderer::flush_touch_input);
+
+    ClassDB::bind_method(D_METHOD("set_display_id", "display_id"), &AynThorRenderer::set_display_id);
+    ClassDB::bind_method(D_METHOD("get_display_id"), &AynThorRenderer::get_display_id);
 
     ClassDB::bind_method(D_METHOD("set_target_fps", "fps"), &AynThorRenderer::set_target_fps);
     ClassDB::bind_method(D_METHOD("get_target_fps"), &AynThorRenderer::get_target_fps);
+
+    ClassDB::bind_method(D_METHOD("set_refresh_divisor", "divisor"), &AynThorRenderer::set_refresh_divisor);
+    ClassDB::bind_method(D_METHOD("get_refresh_divisor"), &AynThorRenderer::get_refresh_divisor);
+
+    ClassDB::bind_method(D_METHOD("set_present_mode_policy", "policy"), &AynThorRenderer::set_present_mode_policy);
+    ClassDB::bind_method(D_METHOD("get_present_mode_policy"), &AynThorRenderer::get_present_mode_policy);
+    ClassDB::bind_method(D_METHOD("set_swapchain_format", "format"), &AynThorRenderer::set_swapchain_format);
+    ClassDB::bind_method(D_METHOD("get_swapchain_format"), &AynThorRenderer::get_swapchain_format);
+    ClassDB::bind_method(D_METHOD("set_swapchain_image_count", "count"), &AynThorRenderer::set_swapchain_image_count);
+    ClassDB::bind_method(D_METHOD("get_swapchain_image_count"), &AynThorRenderer::get_swapchain_image_count);
+
+    ClassDB::bind_method(D_METHOD("get_refresh_rate"), &AynThorRenderer::get_refresh_rate);
+    ClassDB::bind_method(D_METHOD("get_pacing_source"), &AynThorRenderer::get_pacing_source);
+
+    ClassDB::bind_method(D_METHOD("set_frames_in_flight", "frames"), &AynThorRenderer::set_frames_in_flight);
+    ClassDB::bind_method(D_METHOD("get_frames_in_flight"), &AynThorRenderer::get_frames_in_flight);
     
     ClassDB::bind_method(D_METHOD("set_rotation_degrees", "degrees"), &AynThorRenderer::set_rotation_degrees);
     ClassDB::bind_method(D_METHOD("get_rotation_degrees"), &AynThorRenderer::get_rotation_degrees);
+    ClassDB::bind_method(D_METHOD("get_rotation_path"), &AynThorRenderer::get_rotation_path);
+    ClassDB::bind_method(D_METHOD("set_compositor_rotation", "enabled"), &AynThorRenderer::set_compositor_rotation);
+    ClassDB::bind_method(D_METHOD("is_compositor_rotation"), &AynThorRenderer::is_compositor_rotation);
 
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "display_id"), "set_display_id", "get_display_id");
     ADD_PROPERTY(PropertyInfo(Variant::INT, "target_fps"), "set_target_fps", "get_target_fps");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "refresh_divisor", PROPERTY_HINT_RANGE, "0,8"), "set_refresh_divisor", "get_refresh_divisor");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "present_mode_policy", PROPERTY_HINT_ENUM, "Low Latency,VSync,Adaptive"), "set_present_mode_policy", "get_present_mode_policy");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "swapchain_format", PROPERTY_HINT_ENUM, "RGBA8,Low Bandwidth,High Precision"), "set_swapchain_format", "get_swapchain_format");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "swapchain_image_count", PROPERTY_HINT_RANGE, "0,8"), "set_swapchain_image_count", "get_swapchain_image_count");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "frames_in_flight", PROPERTY_HINT_RANGE, "1,4"), "set_frames_in_flight", "get_frames_in_flight");
+    ClassDB::bind_method(D_METHOD("set_threaded_present", "enabled"), &AynThorRenderer::set_threaded_present);
+    ClassDB::bind_method(D_METHOD("is_threaded_present"), &AynThorRenderer::is_threaded_present);
+
+    ClassDB::bind_method(D_METHOD("set_frame_policy", "policy"), &AynThorRenderer::set_frame_policy);
+    ClassDB::bind_method(D_METHOD("get_frame_policy"), &AynThorRenderer::get_frame_policy);
+
+    ClassDB::bind_method(D_METHOD("set_scale_mode", "mode"), &AynThorRenderer::set_scale_mode);
+    ClassDB::bind_method(D_METHOD("get_scale_mode"), &AynThorRenderer::get_scale_mode);
+
+    ClassDB::bind_method(D_METHOD("set_sharpness", "sharpness"), &AynThorRenderer::set_sharpness);
+    ClassDB::bind_method(D_METHOD("get_sharpness"), &AynThorRenderer::get_sharpness);
+
+    ClassDB::bind_method(D_METHOD("set_dirty_tracking", "enabled"), &AynThorRenderer::set_dirty_tracking);
+    ClassDB::bind_method(D_METHOD("is_dirty_tracking"), &AynThorRenderer::is_dirty_tracking);
+    ClassDB::bind_method(D_METHOD("mark_dirty", "rect"), &AynThorRenderer::mark_dirty, DEFVAL(Rect2i()));
+
+    ClassDB::bind_method(D_METHOD("set_layer", "id", "texture", "source_rect", "dest_rect", "opacity", "z"), &AynThorRenderer::set_layer, DEFVAL(1.0), DEFVAL(0));
+    ClassDB::bind_method(D_METHOD("remove_layer", "id"), &AynThorRenderer::remove_layer);
+    ClassDB::bind_method(D_METHOD("clear_layers"), &AynThorRenderer::clear_layers);
+    ClassDB::bind_method(D_METHOD("get_layer_count"), &AynThorRenderer::get_layer_count);
+
+    ClassDB::bind_method(D_METHOD("get_dropped_frames"), &AynThorRenderer::get_dropped_frames);
+    ClassDB::bind_method(D_METHOD("get_skipped_frames"), &AynThorRenderer::get_skipped_frames);
+    ClassDB::bind_method(D_METHOD("get_late_frames"), &AynThorRenderer::get_late_frames);
+    ClassDB::bind_method(D_METHOD("reset_frame_counters"), &AynThorRenderer::reset_frame_counters);
+
+    ClassDB::bind_method(D_METHOD("set_latency_probe", "enabled"), &AynThorRenderer::set_latency_probe);
+    ClassDB::bind_method(D_METHOD("is_latency_probe"), &AynThorRenderer::is_latency_probe);
+
+    ClassDB::bind_method(D_METHOD("get_swapchain_recreations"), &AynThorRenderer::get_swapchain_recreations);
+    ClassDB::bind_method(D_METHOD("get_stats"), &AynThorRenderer::get_stats);
+    ClassDB::bind_method(D_METHOD("set_performance_monitors", "enabled"), &AynThorRenderer::set_performance_monitors);
+    ClassDB::bind_method(D_METHOD("is_performance_monitors"), &AynThorRenderer::is_performance_monitors);
+    ClassDB::bind_method(D_METHOD("start_stats_trace", "path", "format"), &AynThorRenderer::start_stats_trace, DEFVAL(TRACE_FORMAT_CSV));
+    ClassDB::bind_method(D_METHOD("stop_stats_trace"), &AynThorRenderer::stop_stats_trace);
+
+    ClassDB::bind_method(D_METHOD("set_direct_mode", "enabled"), &AynThorRenderer::set_direct_mode);
+    ClassDB::bind_method(D_METHOD("is_direct_mode"), &AynThorRenderer::is_direct_mode);
+    ClassDB::bind_method(D_METHOD("is_direct_active"), &AynThorRenderer::is_direct_active);
+
+    ClassDB::bind_method(D_METHOD("set_update_policy", "policy"), &AynThorRenderer::set_update_policy);
+    ClassDB::bind_method(D_METHOD("get_update_policy"), &AynThorRenderer::get_update_policy);
+    ClassDB::bind_method(D_METHOD("set_main_update_divisor", "divisor"), &AynThorRenderer::set_main_update_divisor);
+    ClassDB::bind_method(D_METHOD("get_main_update_divisor"), &AynThorRenderer::get_main_update_divisor);
+    ClassDB::bind_method(D_METHOD("set_second_update_divisor", "divisor"), &AynThorRenderer::set_second_update_divisor);
+    ClassDB::bind_method(D_METHOD("get_second_update_divisor"), &AynThorRenderer::get_second_update_divisor);
+    ClassDB::bind_method(D_METHOD("schedule_viewports", "main_viewport", "second_viewport", "second_wanted"), &AynThorRenderer::schedule_viewports, DEFVAL(true));
+
+    ClassDB::bind_method(D_METHOD("set_dynamic_resolution", "enabled"), &AynThorRenderer::set_dynamic_resolution);
+    ClassDB::bind_method(D_METHOD("is_dynamic_resolution"), &AynThorRenderer::is_dynamic_resolution);
+    ClassDB::bind_method(D_METHOD("set_dynamic_resolution_min_scale", "scale"), &AynThorRenderer::set_dynamic_resolution_min_scale);
+    ClassDB::bind_method(D_METHOD("get_dynamic_resolution_min_scale"), &AynThorRenderer::get_dynamic_resolution_min_scale);
+    ClassDB::bind_method(D_METHOD("set_dynamic_resolution_max_scale", "scale"), &AynThorRenderer::set_dynamic_resolution_max_scale);
+    ClassDB::bind_method(D_METHOD("get_dynamic_resolution_max_scale"), &AynThorRenderer::get_dynamic_resolution_max_scale);
+    ClassDB::bind_method(D_METHOD("set_gpu_budget_ms", "budget_ms"), &AynThorRenderer::set_gpu_budget_ms);
+    ClassDB::bind_method(D_METHOD("get_gpu_budget_ms"), &AynThorRenderer::get_gpu_budget_ms);
+    ClassDB::bind_method(D_METHOD("update_dynamic_resolution", "viewport_rid"), &AynThorRenderer::update_dynamic_resolution);
+    ClassDB::bind_method(D_METHOD("get_resolution_scale"), &AynThorRenderer::get_resolution_scale);
+
+    ClassDB::bind_method(D_METHOD("set_capture_fps", "fps"), &AynThorRenderer::set_capture_fps);
+    ClassDB::bind_method(D_METHOD("get_capture_fps"), &AynThorRenderer::get_capture_fps);
+    ClassDB::bind_method(D_METHOD("set_capture_scale", "scale"), &AynThorRenderer::set_capture_scale);
+    ClassDB::bind_method(D_METHOD("get_capture_scale"), &AynThorRenderer::get_capture_scale);
+    ClassDB::bind_method(D_METHOD("start_capture", "shared_path", "file_path", "file_format"), &AynThorRenderer::start_capture, DEFVAL(String()), DEFVAL(String()), DEFVAL(CAPTURE_FILE_RAW));
+    ClassDB::bind_method(D_METHOD("stop_capture"), &AynThorRenderer::stop_capture);
+    ClassDB::bind_method(D_METHOD("is_capturing"), &AynThorRenderer::is_capturing);
+    ClassDB::bind_method(D_METHOD("get_capture_fd"), &AynThorRenderer::get_capture_fd);
+
     ADD_PROPERTY(PropertyInfo(Variant::INT, "rotation_degrees"), "set_rotation_degrees", "get_rotation_degrees");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "compositor_rotation"), "set_compositor_rotation", "is_compositor_rotation");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "threaded_present"), "set_threaded_present", "is_threaded_present");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "frame_policy", PROPERTY_HINT_ENUM, "Drop,Reuse Last,Block"), "set_frame_policy", "get_frame_policy");
+
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "scale_mode", PROPERTY_HINT_ENUM, "Blit,Integer,Sharp Bilinear,Edge Adaptive"), "set_scale_mode", "get_scale_mode");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "sharpness", PROPERTY_HINT_RANGE, "0,1,0.01"), "set_sharpness", "get_sharpness");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "dirty_tracking"), "set_dirty_tracking", "is_dirty_tracking");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "latency_probe"), "set_latency_probe", "is_latency_probe");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "performance_monitors"), "set_performance_monitors", "is_performance_monitors");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "direct_mode"), "set_direct_mode", "is_direct_mode");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "update_policy", PROPERTY_HINT_ENUM, "Always,Divisor,Staggered,VSync"), "set_update_policy", "get_update_policy");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "main_update_divisor", PROPERTY_HINT_RANGE, "1,8"), "set_main_update_divisor", "get_main_update_divisor");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "second_update_divisor", PROPERTY_HINT_RANGE, "1,8"), "set_second_update_divisor", "get_second_update_divisor");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "dynamic_resolution"), "set_dynamic_resolution", "is_dynamic_resolution");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "dynamic_resolution_min_scale", PROPERTY_HINT_RANGE, "0.25,1,0.05"), "set_dynamic_resolution_min_scale", "get_dynamic_resolution_min_scale");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "dynamic_resolution_max_scale", PROPERTY_HINT_RANGE, "0.25,1,0.05"), "set_dynamic_resolution_max_scale", "get_dynamic_resolution_max_scale");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "gpu_budget_ms", PROPERTY_HINT_RANGE, "0.5,33,0.5"), "set_gpu_budget_ms", "get_gpu_budget_ms");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "capture_fps", PROPERTY_HINT_RANGE, "0,240"), "set_capture_fps", "get_capture_fps");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "capture_scale", PROPERTY_HINT_RANGE, "0.1,1,0.05"), "set_capture_scale", "get_capture_scale");
+
+    // Emitted once the surface and swapchain for a new window exist.
+    ADD_SIGNAL(MethodInfo("output_ready"));
+
+    BIND_ENUM_CONSTANT(FRAME_POLICY_DROP);
+    BIND_ENUM_CONSTANT(FRAME_POLICY_BLOCK);
+
+    BIND_ENUM_CONSTANT(SCALE_MODE_BLIT);
+    BIND_ENUM_CONSTANT(SCALE_MODE_INTEGER);
+    BIND_ENUM_CONSTANT(SCALE_MODE_SHARP_BILINEAR);
+    BIND_ENUM_CONSTANT(SCALE_MODE_EDGE_ADAPTIVE);
+
+    BIND_ENUM_CONSTANT(PRESENT_MODE_LOW_LATENCY);
+    BIND_ENUM_CONSTANT(PRESENT_MODE_VSYNC);
+    BIND_ENUM_CONSTANT(PRESENT_MODE_ADAPTIVE);
+
+    BIND_ENUM_CONSTANT(PACING_ACCUMULATOR);
+    BIND_ENUM_CONSTANT(PACING_DISPLAY_TIMING);
+    BIND_ENUM_CONSTANT(PACING_PRESENT_WAIT);
+
+    BIND_ENUM_CONSTANT(TRACE_FORMAT_CSV);
+    BIND_ENUM_CONSTANT(TRACE_FORMAT_CHROME);
+
+    BIND_ENUM_CONSTANT(CAPTURE_FILE_RAW);
+    BIND_ENUM_CONSTANT(CAPTURE_FILE_QOI);
+
+    BIND_ENUM_CONSTANT(UPDATE_POLICY_ALWAYS);
+    BIND_ENUM_CONSTANT(UPDATE_POLICY_DIVISOR);
+    BIND_ENUM_CONSTANT(UPDATE_POLICY_STAGGERED);
+    BIND_ENUM_CONSTANT(UPDATE_POLICY_VSYNC);
+
+    BIND_BITFIELD_FLAG(SCHEDULE_SECOND_RENDERING);
+    BIND_BITFIELD_FLAG(SCHEDULE_SECOND_READY);
+
+    BIND_ENUM_CONSTANT(ROTATION_PATH_PRE_TRANSFORM);
+    BIND_ENUM_CONSTANT(ROTATION_PATH_COPY);
+    BIND_ENUM_CONSTANT(ROTATION_PATH_COMPOSITOR);
+    BIND_ENUM_CONSTANT(ROTATION_PATH_NONE);
+
+    BIND_ENUM_CONSTANT(LATENCY_SOURCE_NONE);
+    BIND_ENUM_CONSTANT(LATENCY_SOURCE_DISPLAY_TIMING);
+    BIND_ENUM_CONSTANT(LATENCY_SOURCE_PRESENT_WAIT);
+    BIND_ENUM_CONSTANT(LATENCY_SOURCE_FENCE);
 }
 
-AynThorRenderer::AynThorRenderer() {}
+AynThorRenderer::AynThorRenderer() {
+    setup_listener.renderer = this;
+}
 
 AynThorRenderer::~AynThorRenderer() {
+    _stop_setup_thread();
+    _stop_present_thread();
+    _unregister_direct_interface();
     _cleanup_vulkan();
+    capture.stop();
+    _release_touch_ring();
 }
 
-void AynThorRenderer::set_target_fps(int p_fps) { target_fps = p_fps; }
-int AynThorRenderer::get_target_fps() const { return target_fps; }
+void AynThorRenderer::_notification(int p_what) {
+    if (p_what == NOTIFICATION_ENTER_TREE) {
+        if (performance_monitors) _register_monitors();
+        if (_prepare_device()) _start_setup_thread();
+    } else if (p_what == NOTIFICATION_EXIT_TREE) {
+        _stop_setup_thread();
+        _unregister_monitors();
+        _set_direct_frames(false);
+        _unregister_direct_interface();
+        _release_touch_ring();
+    }
+}
 
-void AynThorRenderer::set_rotation_degrees(int p_degrees) { rotation_degrees = p_degrees; }
-int AynThorRenderer::get_rotation_degrees() const { return rotation_degrees; }
+void AynThorRenderer::set_display_id(int p_display_id) { display_id.store(p_display_id); }
+int AynThorRenderer::get_display_id() const { return display_id.load(); }
 
-bool AynThorRenderer::is_window_available() {
-    std::lock_guard<std::mutex> lock(g_window_mutex);
-    return g_second_window != nullptr;
+int32_t AynThorRenderer::_resolve_display_id() const {
+    int id = display_id.load(std::memory_order_relaxed);
+    return id >= 0 ? id : AynThorDisplayRegistry::get_singleton()->get_default_display_id();
 }
 
-Vector2i AynThorRenderer::get_second_screen_size() {
-    std::lock_guard<std::mutex> lock(g_window_mutex);
+void AynThorRenderer::set_target_fps(int p_fps) {
+    target_fps.store(p_fps);
+    pacing_dirty.store(true);
+}
+int AynThorRenderer::get_target_fps() const { return target_fps.load(); }
+
+void AynThorRenderer::set_refresh_divisor(int p_divisor) {
+    refresh_divisor.store(MAX(p_divisor, 0));
+    pacing_dirty.store(true);
+}
+int AynThorRenderer::get_refresh_divisor() const { return refresh_divisor.load(); }
+
+void AynThorRenderer::set_present_mode_policy(PresentModePolicy p_policy) {
+    if (p_policy == present_mode_policy.load()) return;
+    present_mode_policy.store(p_policy);
+    swapchain_dirty.store(true);
+}
+AynThorRenderer::PresentModePolicy AynThorRenderer::get_present_mode_policy() const { return present_mode_policy.load(); }
+
+void AynThorRenderer::set_swapchain_format(SwapchainFormat p_format) {
+    if (p_format == swapchain_format.load()) return;
+    swapchain_format.store(p_format);
+    swapchain_dirty.store(true);
+}
+AynThorRenderer::SwapchainFormat AynThorRenderer::get_swapchain_format() const { return swapchain_format.load(); }
+
+void AynThorRenderer::set_swapchain_image_count(int p_count) {
+    p_count = CLAMP(p_count, 0, 8);
+    if (p_count == swapchain_image_count.load()) return;
+    swapchain_image_count.store(p_count);
+    swapchain_dirty.store(true);
+}
+int AynThorRenderer::get_swapchain_image_count() const { return swapchain_image_count.load(); }
+
+float AynThorRenderer::get_refresh_rate() const {
+    return (float)(1e9 / (double)pacer.get_refresh_period_ns());
+}
+
+AynThorRenderer::PacingSource AynThorRenderer::get_pacing_source() const {
 #ifdef __ANDROID__
-    if (g_second_window) {
-        return Vector2i(ANativeWindow_getWidth(g_second_window), ANativeWindow_getHeight(g_second_window));
+    if (fp_get_past_presentation_timing) return PACING_DISPLAY_TIMING;
+    if (fp_wait_for_present && present_thread_running.load()) return PACING_PRESENT_WAIT;
+#endif
+    return PACING_ACCUMULATOR;
+}
+
+void AynThorRenderer::set_frames_in_flight(int p_frames) {
+    if (p_frames < 1) p_frames = 1;
+    if (p_frames > MAX_FRAMES_IN_FLIGHT) p_frames = MAX_FRAMES_IN_FLIGHT;
+    if (p_frames == frames_in_flight) return;
+    std::lock_guard<std::mutex> output_lock(output_mutex);
+    frames_in_flight = p_frames;
+#ifdef __ANDROID__
+    if (initialized) {
+        bool restart_thread = present_thread.joinable();
+        _stop_present_thread();
+        _destroy_frame_contexts();
+        if (!_create_frame_contexts()) {
+            _cleanup_vulkan();
+        } else if (restart_thread) {
+            _start_present_thread();
+        }
     }
 #endif
-    return Vector2i(0, 0);
 }
+int AynThorRenderer::get_frames_in_flight() const { return frames_in_flight; }
+
+void AynThorRenderer::set_threaded_present(bool p_enabled) {
+    if (p_enabled == threaded_present) return;
+    std::lock_guard<std::mutex> output_lock(output_mutex);
+    threaded_present = p_enabled;
+    if (threaded_present) {
+        _start_present_thread();
+    } else {
+        _stop_present_thread();
+    }
+}
+bool AynThorRenderer::is_threaded_present() const { return threaded_present; }
 
-void AynThorRenderer::_init_vulkan() {
+void AynThorRenderer::set_frame_policy(FramePolicy p_policy) {
+    frame_policy.store(p_policy);
+    std::lock_guard<std::mutex> lock(present_wake_mutex);
+    present_wake_cv.notify_one();
+}
+AynThorRenderer::FramePolicy AynThorRenderer::get_frame_policy() const { return frame_policy.load(); }
+
+void AynThorRenderer::set_scale_mode(ScaleMode p_mode) {
+    scale_mode.store(p_mode);
+    content_invalidated.store(true);
+}
+AynThorRenderer::ScaleMode AynThorRenderer::get_scale_mode() const { return scale_mode.load(); }
+
+void AynThorRenderer::set_sharpness(float p_sharpness) {
+    sharpness.store(CLAMP(p_sharpness, 0.0f, 1.0f));
+    content_invalidated.store(true);
+}
+float AynThorRenderer::get_sharpness() const { return sharpness.load(); }
+
+void AynThorRenderer::set_dirty_tracking(bool p_enabled) {
+    dirty_tracking = p_enabled;
+    content_invalidated.store(true);
+}
+bool AynThorRenderer::is_dirty_tracking() const { return dirty_tracking; }
+
+void AynThorRenderer::mark_dirty(const Rect2i& p_rect) {
+    if (!p_rect.has_area()) {
+        damage_full = true;
+    } else {
+        damage_rect = damage_pending ? damage_rect.merge(p_rect) : p_rect;
+    }
+    damage_pending = true;
+}
+
+void AynThorRenderer::set_layer(int p_id, RID p_texture, const Rect2i& p_source_rect, const Rect2i& p_dest_rect, float p_opacity, int p_z) {
+    LayerEntry *entry = nullptr;
+    for (LayerEntry &layer : layers) {
+        if (layer.id == p_id) entry = &layer;
+    }
+    if (!entry) {
+        if (layers.size() >= AynThorScaler::MAX_LAYERS) {
+            UtilityFunctions::printerr("AynThorPlugin: At most ", (int)AynThorScaler::MAX_LAYERS, " layers are supported.");
+            return;
+        }
+        layers.push_back(LayerEntry());
+        entry = &layers.back();
+        entry->id = p_id;
+    }
+    entry->texture = p_texture;
+    entry->source_rect = p_source_rect;
+    entry->dest_rect = p_dest_rect;
+    entry->opacity = CLAMP(p_opacity, 0.0f, 1.0f);
+    entry->z = p_z;
+    entry->stale = true;
+    // Stable, so layers on the same z keep the order they were added in.
+    std::stable_sort(layers.begin(), layers.end(), [](const LayerEntry& a, const LayerEntry& b) { return a.z < b.z; });
+    layers_version++;
+}
+
+void AynThorRenderer::remove_layer(int p_id) {
+    for (size_t i = 0; i < layers.size(); i++) {
+        if (layers[i].id != p_id) continue;
+        layers.erase(layers.begin() + i);
+        layers_version++;
+        return;
+    }
+}
+
+void AynThorRenderer::clear_layers() {
+    if (layers.empty()) return;
+    layers.clear();
+    layers_version++;
+}
+
+int AynThorRenderer::get_layer_count() const { return (int)layers.size(); }
+
+void AynThorRenderer::set_latency_probe(bool p_enabled) {
+    if (p_enabled == latency_probe_enabled) return;
+    latency_probe_enabled = p_enabled;
+    // Touches left from before would be paired with the wrong frames.
+    while (latency_probe.take_reflected(UINT64_MAX) != 0) {}
+    latency_probe.reset();
+}
+bool AynThorRenderer::is_latency_probe() const { return latency_probe_enabled; }
+
+int64_t AynThorRenderer::get_dropped_frames() const { return (int64_t)dropped_frames.load(); }
+int64_t AynThorRenderer::get_late_frames() const { return (int64_t)late_frames.load(); }
+int64_t AynThorRenderer::get_skipped_frames() const { return (int64_t)skipped_frames.load(); }
+
+void AynThorRenderer::reset_frame_counters() {
+    dropped_frames.store(0);
+    late_frames.store(0);
+    skipped_frames.store(0);
+    swapchain_recreations.store(0);
+    frame_stats.reset();
+    latency_probe.reset();
+}
+
+int64_t AynThorRenderer::get_swapchain_recreations() const { return (int64_t)swapchain_recreations.load(); }
+
+Dictionary AynThorRenderer::get_stats() {
+    // Timings are in microseconds over the last AynThorFrameStats::WINDOW presents.
+    Dictionary stats;
+    for (int i = 0; i < AynThorFrameStats::METRIC_MAX; i++) {
+        AynThorFrameStats::Percentiles percentiles = frame_stats.get_percentiles((AynThorFrameStats::Metric)i);
+        Dictionary entry;
+        entry["p50"] = percentiles.p50;
+        entry["p95"] = percentiles.p95;
+        entry["p99"] = percentiles.p99;
+        entry["samples"] = (int64_t)percentiles.count;
+        stats[AynThorFrameStats::get_metric_name((AynThorFrameStats::Metric)i)] = entry;
+    }
+    // From the MotionEvent time of the oldest touch a frame reflects to
+    // when that frame reached the panel; only filled by the latency probe.
+    AynThorLatencyProbe::Distribution latency = latency_probe.get_distribution();
+    Dictionary touch_to_present;
+    touch_to_present["p50"] = latency.p50;
+    touch_to_present["p95"] = latency.p95;
+    touch_to_present["p99"] = latency.p99;
+    touch_to_present["min"] = latency.min;
+    touch_to_present["max"] = latency.max;
+    touch_to_present["samples"] = (int64_t)latency.count;
+    touch_to_present["source"] = (int64_t)latency.source;
+    stats["touch_to_present"] = touch_to_present;
+    stats["swapchain_recreations"] = get_swapchain_recreations();
+    stats["skipped_frames"] = get_skipped_frames();
+    stats["dropped_frames"] = get_dropped_frames();
+    stats["late_frames"] = get_late_frames();
+    stats["captured_frames"] = (int64_t)capture.get_captured_frames();
+    stats["capture_dropped_frames"] = (int64_t)capture.get_dropped_frames();
+    stats["resolution_scale"] = get_resolution_scale();
+
+    // Footprint of the second panel: swapchain memory, and what a present
+    // moves, the source read plus the swapchain image written, in bytes.
+    uint64_t image_bytes = swapchain_image_bytes.load();
+    uint64_t read_bytes = 0;
+#ifdef __ANDROID__
+    {
+        // The setup thread clears the source cache on tear-down.
+        std::unique_lock<std::mutex> output_lock(output_mutex, std::try_to_lock);
+        const SourceFrame& source = cached_sources[last_source_slot];
+        if (output_lock.owns_lock() && cached_source_rd_textures[last_source_slot].is_valid()) read_bytes = (uint64_t)source.width * source.height * source.bytes_per_pixel;
+    }
+    stats["swapchain_format"] = _format_name(swapchain_vk_format.load());
+#else
+    stats["swapchain_format"] = "";
+#endif
+    stats["swapchain_images"] = (int64_t)swapchain_images_created.load();
+    stats["rotation_path"] = (int64_t)rotation_path.load();
+    stats["pre_transform_degrees"] = (int64_t)present_transform_degrees.load();
+    stats["copy_rotation_degrees"] = (int64_t)copy_rotation_degrees.load();
+    stats["swapchain_memory_bytes"] = (int64_t)(image_bytes * swapchain_images_created.load());
+    stats["frame_bytes"] = (int64_t)(image_bytes + read_bytes);
+    uint64_t interval_usec = _frame_interval_usec();
+    stats["bandwidth_bytes_per_second"] = interval_usec > 0 ? (int64_t)((image_bytes + read_bytes) * 1000000 / interval_usec) : (int64_t)0;
+#ifdef __ANDROID__
+    stats["gpu_timestamps"] = ring.has_timestamps();
+#else
+    stats["gpu_timestamps"] = false;
+#endif
+    return stats;
+}
+
+void AynThorRenderer::set_performance_monitors(bool p_enabled) {
+    if (p_enabled == performance_monitors) return;
+    performance_monitors = p_enabled;
+    if (performance_monitors && is_inside_tree()) {
+        _register_monitors();
+    } else if (!performance_monitors) {
+        _unregister_monitors();
+    }
+}
+bool AynThorRenderer::is_performance_monitors() const { return performance_monitors; }
+
+void AynThorRenderer::_register_monitors() {
+    Performance* performance = Performance::get_singleton();
+    if (monitors_registered || !performance) return;
+
+    // One category per node so the monitors of several displays do not clash.
+    monitor_category = String("AynThor ") + String(get_name());
+    for (int i = 0; i < MONITOR_MAX; i++) {
+        Array arguments;
+        arguments.push_back(i);
+        performance->add_custom_monitor(monitor_category + "/" + _monitor_name(i), callable_mp(this, &AynThorRenderer::_get_monitor_value), arguments);
+    }
+    monitors_registered = true;
+}
+
+void AynThorRenderer::_unregister_monitors() {
+    Performance* performance = Performance::get_singleton();
+    if (!monitors_registered || !performance) return;
+    for (int i = 0; i < MONITOR_MAX; i++) {
+        StringName id = monitor_category + "/" + _monitor_name(i);
+        if (performance->has_custom_monitor(id)) performance->remove_custom_monitor(id);
+    }
+    monitors_registered = false;
+}
+
+double AynThorRenderer::_get_monitor_value(int p_index) {
+    if (p_index < MONITOR_SWAPCHAIN_RECREATIONS) {
+        AynThorFrameStats::Percentiles percentiles = frame_stats.get_percentiles((AynThorFrameStats::Metric)(p_index / 3));
+        double values[3] = {percentiles.p50, percentiles.p95, percentiles.p99};
+        return values[p_index % 3];
+    }
+    switch (p_index) {
+        case MONITOR_SWAPCHAIN_RECREATIONS: return (double)swapchain_recreations.load(std::memory_order_relaxed);
+        case MONITOR_SKIPPED_FRAMES: return (double)skipped_frames.load(std::memory_order_relaxed);
+        case MONITOR_DROPPED_FRAMES: return (double)dropped_frames.load(std::memory_order_relaxed);
+        default: return (double)late_frames.load(std::memory_order_relaxed);
+    }
+}
+
+bool AynThorRenderer::start_stats_trace(const String& p_path, TraceFormat p_format) {
+    String path = ProjectSettings::get_singleton()->globalize_path(p_path);
+    AynThorFrameStats::TraceFormat format = p_format == TRACE_FORMAT_CHROME ? AynThorFrameStats::TRACE_CHROME : AynThorFrameStats::TRACE_CSV;
+    if (!frame_stats.start_trace(path.utf8().get_data(), format)) {
+        UtilityFunctions::printerr("AynThorPlugin: Could not open stats trace ", p_path);
+        return false;
+    }
+    return true;
+}
+
+void AynThorRenderer::stop_stats_trace() {
+    frame_stats.stop_trace();
+}
+
+void AynThorRenderer::set_capture_fps(int p_fps) {
+    capture_fps = MAX(p_fps, 0);
+    capture.configure(capture_fps, capture_scale);
+}
+int AynThorRenderer::get_capture_fps() const { return capture_fps; }
+
+void AynThorRenderer::set_capture_scale(float p_scale) {
+    capture_scale = CLAMP(p_scale, 0.1f, 1.0f);
+    capture.configure(capture_fps, capture_scale);
+}
+float AynThorRenderer::get_capture_scale() const { return capture_scale; }
+
+void AynThorRenderer::set_update_policy(UpdatePolicy p_policy) {
+    if (update_policy == UPDATE_POLICY_STAGGERED && p_policy != UPDATE_POLICY_STAGGERED) {
+        for (RID& viewport : staggered_viewports) {
+            if (viewport.is_valid() && viewport != measured_viewport) RenderingServer::get_singleton()->viewport_set_measure_render_time(viewport, false);
+            viewport = RID();
+        }
+    }
+    update_policy = p_policy;
+    viewport_scheduler.configure((AynThorViewportScheduler::Policy)update_policy, main_update_divisor, second_update_divisor);
+    // The pacer is ticked at render time under VSync, at present time otherwise.
+    pacing_dirty.store(true);
+}
+AynThorRenderer::UpdatePolicy AynThorRenderer::get_update_policy() const { return update_policy; }
+
+void AynThorRenderer::set_main_update_divisor(int p_divisor) {
+    main_update_divisor = CLAMP(p_divisor, 1, 8);
+    viewport_scheduler.configure((AynThorViewportScheduler::Policy)update_policy, main_update_divisor, second_update_divisor);
+}
+int AynThorRenderer::get_main_update_divisor() const { return main_update_divisor; }
+
+void AynThorRenderer::set_second_update_divisor(int p_divisor) {
+    second_update_divisor = CLAMP(p_divisor, 1, 8);
+    viewport_scheduler.configure((AynThorViewportScheduler::Policy)update_policy, main_update_divisor, second_update_divisor);
+}
+int AynThorRenderer::get_second_update_divisor() const { return second_update_divisor; }
+
+BitField<AynThorRenderer::ScheduleFlags> AynThorRenderer::schedule_viewports(Viewport* p_main, Viewport* p_second, bool p_second_wanted) {
+    uint64_t now = _monotonic_ns();
+    if (last_schedule_ns != 0) {
+        uint64_t frame_ns = now - last_schedule_ns;
+        engine_frame_ns = engine_frame_ns == 0 ? frame_ns : (engine_frame_ns * 7 + frame_ns) / 8;
+    }
+    last_schedule_ns = now;
+
+    // What rendered at the end of the last frame is complete by now, as far
+    // as the copy is concerned: it is queued ahead of it.
+    BitField<ScheduleFlags> flags = 0;
+    if (second_render_pending) flags.set_flag(SCHEDULE_SECOND_READY);
+    second_render_pending = false;
+
+    bool tight = false;
+    if (update_policy == UPDATE_POLICY_STAGGERED && p_main && p_second) {
+        RenderingServer* rs = RenderingServer::get_singleton();
+        staggered_viewports[0] = p_main->get_viewport_rid();
+        staggered_viewports[1] = p_second->get_viewport_rid();
+        double gpu_ms = 0.0;
+        for (const RID& viewport : staggered_viewports) {
+            rs->viewport_set_measure_render_time(viewport, true);
+            gpu_ms += rs->viewport_get_measured_render_time_gpu(viewport);
+        }
+        // Both would not fit into one engine frame with some headroom.
+        tight = engine_frame_ns > 0 && gpu_ms * 1e6 > (double)engine_frame_ns * 0.9;
+    }
+
+    bool second_due = true;
+    if (update_policy == UPDATE_POLICY_VSYNC && p_second_wanted) {
+        // The frame is presented on the next engine frame, so ask whether a
+        // panel slot comes up by then.
+        _update_pacing();
+        second_due = pacer.tick(now + engine_frame_ns);
+    }
+
+    AynThorViewportScheduler::Decision decision = viewport_scheduler.next(p_second_wanted && p_second, second_due, tight);
+
+    // UPDATE_ONCE falls back to UPDATE_DISABLED after rendering, so whatever
+    // is not picked keeps its last completed frame.
+    SubViewport* main_viewport = Object::cast_to<SubViewport>(p_main);
+    if (main_viewport) main_viewport->set_update_mode(decision.main ? SubViewport::UPDATE_ONCE : SubViewport::UPDATE_DISABLED);
+    SubViewport* second_viewport = Object::cast_to<SubViewport>(p_second);
+    if (second_viewport) second_viewport->set_update_mode(decision.second ? SubViewport::UPDATE_ONCE : SubViewport::UPDATE_DISABLED);
+
+    if (decision.second) {
+        previous_second_render_frame = second_render_frame;
+        second_render_frame = Engine::get_singleton()->get_process_frames();
+        second_render_pending = true;
+        flags.set_flag(SCHEDULE_SECOND_RENDERING);
+    }
+    return flags;
+}
+
+void AynThorRenderer::set_dynamic_resolution(bool p_enabled) {
+    if (p_enabled == dynamic_resolution) return;
+    dynamic_resolution = p_enabled;
+    resolution_controller.reset();
+    if (!dynamic_resolution && measured_viewport.is_valid()) {
+        // Measuring costs a query pair per render; only pay it while in use.
+        RenderingServer::get_singleton()->viewport_set_measure_render_time(measured_viewport, false);
+        measured_viewport = RID();
+    }
+}
+bool AynThorRenderer::is_dynamic_resolution() const { return dynamic_resolution; }
+
+void AynThorRenderer::set_dynamic_resolution_min_scale(float p_scale) {
+    dynamic_resolution_min_scale = CLAMP(p_scale, 0.25f, 1.0f);
+    resolution_controller.configure(dynamic_resolution_min_scale, dynamic_resolution_max_scale, gpu_budget_ms * 1000.0);
+}
+float AynThorRenderer::get_dynamic_resolution_min_scale() const { return dynamic_resolution_min_scale; }
+
+void AynThorRenderer::set_dynamic_resolution_max_scale(float p_scale) {
+    dynamic_resolution_max_scale = CLAMP(p_scale, 0.25f, 1.0f);
+    resolution_controller.configure(dynamic_resolution_min_scale, dynamic_resolution_max_scale, gpu_budget_ms * 1000.0);
+}
+float AynThorRenderer::get_dynamic_resolution_max_scale() const { return dynamic_resolution_max_scale; }
+
+void AynThorRenderer::set_gpu_budget_ms(float p_budget_ms) {
+    gpu_budget_ms = CLAMP(p_budget_ms, 0.5f, 33.0f);
+    resolution_controller.configure(dynamic_resolution_min_scale, dynamic_resolution_max_scale, gpu_budget_ms * 1000.0);
+}
+float AynThorRenderer::get_gpu_budget_ms() const { return gpu_budget_ms; }
+
+float AynThorRenderer::update_dynamic_resolution(RID p_viewport_rid) {
+    if (!dynamic_resolution || !p_viewport_rid.is_valid()) return 1.0f;
+
+    RenderingServer* rs = RenderingServer::get_singleton();
+    if (p_viewport_rid != measured_viewport) {
+        if (measured_viewport.is_valid()) rs->viewport_set_measure_render_time(measured_viewport, false);
+        rs->viewport_set_measure_render_time(p_viewport_rid, true);
+        measured_viewport = p_viewport_rid;
+        resolution_controller.reset();
+        return resolution_controller.get_scale();
+    }
+
+    // The viewport's own render plus our copy of it: everything the second
+    // screen takes from the GPU the main screen also needs.
+    double gpu_usec = rs->viewport_get_measured_render_time_gpu(p_viewport_rid) * 1000.0;
+    double copy_usec = last_gpu_copy_usec.load(std::memory_order_relaxed);
+    if (gpu_usec > 0.0 && copy_usec > 0.0) gpu_usec += copy_usec;
+    resolution_controller.update(gpu_usec);
+    return resolution_controller.get_scale();
+}
+
+float AynThorRenderer::get_resolution_scale() const {
+    return dynamic_resolution ? resolution_controller.get_scale() : 1.0f;
+}
+
+bool AynThorRenderer::start_capture(const String& p_shared_path, const String& p_file_path, CaptureFileFormat p_file_format) {
+    AynThorCapture::Settings settings;
+    settings.fps = capture_fps;
+    settings.scale = capture_scale;
+    if (!p_shared_path.is_empty()) settings.shared_path = ProjectSettings::get_singleton()->globalize_path(p_shared_path).utf8().get_data();
+    if (!p_file_path.is_empty()) settings.file_path = ProjectSettings::get_singleton()->globalize_path(p_file_path).utf8().get_data();
+    settings.file_format = p_file_format == CAPTURE_FILE_QOI ? AynThorCapture::FILE_QOI : AynThorCapture::FILE_RAW;
+
+    if (!capture.start(settings)) {
+        UtilityFunctions::printerr("AynThorPlugin: Could not start second screen capture.");
+        return false;
+    }
+    // The swapchain images need TRANSFER_SRC usage to be read back.
+    swapchain_dirty.store(true);
+    return true;
+}
+
+void AynThorRenderer::stop_capture() {
+    capture.stop();
+}
+
+bool AynThorRenderer::is_capturing() const { return capture.is_active(); }
+int AynThorRenderer::get_capture_fd() const { return capture.get_shared_fd(); }
+
+void AynThorRenderer::set_direct_mode(bool p_enabled) {
+    if (p_enabled == direct_mode) return;
+    direct_mode = p_enabled;
+    direct_unavailable = false;
+    if (!direct_mode) {
+        _set_direct_frames(false);
+        _unregister_direct_interface();
+    }
+}
+bool AynThorRenderer::is_direct_mode() const { return direct_mode; }
+bool AynThorRenderer::is_direct_active() const { return direct_frames && direct_swapchain.load(); }
+
+bool AynThorRenderer::draw_viewport_direct(Viewport* p_viewport) {
+#ifdef __ANDROID__
+    // The setup thread is busy; the caller's copy skips the frame as well.
+    std::unique_lock<std::mutex> output_lock(output_mutex, std::try_to_lock);
+    if (!output_lock.owns_lock()) return false;
+
+    // Direct mode wraps the swapchain in RenderingDevice textures, so its
+    // setup stays on the main thread.
+    if (!direct_mode || !p_viewport || !_register_direct_interface() || !_prepare_output(false)) {
+        _set_direct_frames(false);
+        return false;
+    }
+    _set_direct_frames(true);
+
+    // The swapchain is only rebuilt here, between Godot's frames, because
+    // the textures that wrap it have to be replaced as well.
+    uint64_t generation = active_display->surface_generation.load(std::memory_order_acquire);
+    if (generation != surface_generation) {
+        surface_generation = generation;
+        swapchain_dirty.store(true);
+    }
+    if (swapchain_dirty.exchange(false) || !swapchain) {
+        if (!_recreate_swapchain()) {
+            _cleanup_vulkan();
+            return false;
+        }
+    }
+    if (!direct_swapchain.load()) {
+        // Format, usage or transform do not line up; the caller copies.
+        _set_direct_frames(false);
+        return false;
+    }
+
+    if (direct_viewport_id != p_viewport->get_instance_id()) {
+        _release_direct_viewport();
+        direct_viewport_id = p_viewport->get_instance_id();
+        SubViewport* sub_viewport = Object::cast_to<SubViewport>(p_viewport);
+        if (sub_viewport) direct_viewport_size = sub_viewport->get_size();
+        p_viewport->set_use_xr(true);
+    }
+    // Keep the scene-side size in step with the image, so 2D layout and
+    // touch input match what is rendered.
+    SubViewport* sub_viewport = Object::cast_to<SubViewport>(p_viewport);
+    if (sub_viewport && sub_viewport->get_size() != Vector2i((int32_t)width, (int32_t)height)) {
+        sub_viewport->set_size(Vector2i((int32_t)width, (int32_t)height));
+    }
+
+    Camera3D* camera = p_viewport->get_camera_3d();
+    direct_camera_transform = camera ? camera->get_global_transform() : Transform3D();
+    direct_camera_projection = camera ? camera->get_camera_projection() : Projection();
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AynThorRenderer::_set_direct_frames(bool p_direct) {
+    if (p_direct == direct_frames.load()) return;
+    // The textures are RenderingDevice resources and must be freed here on
+    // the main thread. Once direct_frames is clear the setup and present
+    // threads may rebuild the swapchain, and find nothing left to free.
+    if (!p_direct) _destroy_direct_textures();
+    direct_frames.store(p_direct);
+    swapchain_dirty.store(true);
+    content_invalidated.store(true);
+    if (p_direct) {
+        // Godot's frame drives presentation now.
+        _stop_present_thread();
+    } else {
+        _release_direct_viewport();
+        if (threaded_present && initialized) _start_present_thread();
+    }
+}
+
+void AynThorRenderer::_release_direct_viewport() {
+    if (direct_viewport_id == 0) return;
+    Viewport* viewport = Object::cast_to<Viewport>(ObjectDB::get_instance(direct_viewport_id));
+    direct_viewport_id = 0;
+    if (!viewport) return;
+
+    viewport->set_use_xr(false);
+    SubViewport* sub_viewport = Object::cast_to<SubViewport>(viewport);
+    if (sub_viewport) {
+        sub_viewport->set_size(direct_viewport_size);
+        // XR sized the render target behind the viewport's back.
+        RenderingServer::get_singleton()->viewport_set_size(viewport->get_viewport_rid(), direct_viewport_size.x, direct_viewport_size.y);
+    }
+}
+
+bool AynThorRenderer::_register_direct_interface() {
+    if (direct_interface.is_valid()) return true;
+    if (direct_unavailable) return false;
+
+    // With a separate render thread the interface callbacks would race the
+    // main thread, which owns the swapchain.
+    ProjectSettings* settings = ProjectSettings::get_singleton();
+    XRServer* xr_server = XRServer::get_singleton();
+    if ((int)settings->get_setting("rendering/driver/threads/thread_model", 1) == 2) {
+        UtilityFunctions::printerr("AynThorPlugin: Direct mode needs rendering on the main thread, using the copy path.");
+        direct_unavailable = true;
+        return false;
+    }
+    if (!xr_server || xr_server->get_primary_interface().is_valid()) {
+        UtilityFunctions::printerr("AynThorPlugin: Another XR interface is active, direct mode uses the copy path.");
+        direct_unavailable = true;
+        return false;
+    }
+
+    direct_interface.instantiate();
+    direct_interface->set_renderer(this);
+    xr_server->add_interface(direct_interface);
+    if (!direct_interface->initialize()) {
+        _unregister_direct_interface();
+        direct_unavailable = true;
+        return false;
+    }
+    return true;
+}
+
+void AynThorRenderer::_unregister_direct_interface() {
+    _release_direct_viewport();
+    if (direct_interface.is_null()) return;
+
+    direct_interface->uninitialize();
+    XRServer* xr_server = XRServer::get_singleton();
+    if (xr_server) xr_server->remove_interface(direct_interface);
+    direct_interface->set_renderer(nullptr);
+    direct_interface.unref();
+}
+
+bool AynThorRenderer::_create_direct_textures() {
+#ifdef __ANDROID__
+    RenderingDevice* rd = RenderingServer::get_singleton()->get_rendering_device();
+    if (!rd) return false;
+
+    RenderingDevice::DataFormat format = swapchain_image_format == VK_FORMAT_B8G8R8A8_UNORM ? RenderingDevice::DATA_FORMAT_B8G8R8A8_UNORM : RenderingDevice::DATA_FORMAT_R8G8B8A8_UNORM;
+    uint64_t usage = RenderingDevice::TEXTURE_USAGE_COLOR_ATTACHMENT_BIT | RenderingDevice::TEXTURE_USAGE_SAMPLING_BIT | RenderingDevice::TEXTURE_USAGE_CAN_COPY_FROM_BIT;
+    for (VkImage image : swapchain_images) {
+        RID texture = rd->texture_create_from_extension(RenderingDevice::TEXTURE_TYPE_2D, format, RenderingDevice::TEXTURE_SAMPLES_1, usage, (uint64_t)image, width, height, 1, 1);
+        if (!texture.is_valid()) {
+            _destroy_direct_textures();
+            return false;
+        }
+        direct_textures.push_back(texture);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AynThorRenderer::_destroy_direct_textures() {
+#ifdef __ANDROID__
+    direct_acquired = false;
+    direct_swapchain.store(false);
+    // Only ever non-empty on the main thread, see _set_direct_frames; the
+    // setup thread gets here with nothing to free and must not touch the
+    // RenderingServer.
+    if (direct_textures.empty()) return;
+    // Godot defers the frees past the frames that may still use them; the
+    // images themselves belong to the swapchain.
+    RenderingDevice* rd = RenderingServer::get_singleton() ? RenderingServer::get_singleton()->get_rendering_device() : nullptr;
+    for (const RID& texture : direct_textures) {
+        if (rd) rd->free_rid(texture);
+    }
+    direct_textures.clear();
+#endif
+}
+
+Vector2 AynThorRenderer::_direct_target_size() const {
+    return Vector2((float)width, (float)height);
+}
+
+RID AynThorRenderer::_direct_texture() const {
+#ifdef __ANDROID__
+    if (direct_acquired && direct_image_index < direct_textures.size()) return direct_textures[direct_image_index];
+#endif
+    return RID();
+}
+
+bool AynThorRenderer::_direct_acquire() {
+#ifdef __ANDROID__
+    if (direct_acquired) return true;
+    if (!initialized || !direct_frames || !direct_swapchain.load() || frames.empty()) return false;
+
+    _update_pacing();
+    bool paced = update_policy != UPDATE_POLICY_VSYNC;
+    if (paced && !pacer.tick(_monotonic_ns())) return false;
+
+    direct_timing = AynThorFrameStats::FrameTiming();
+    PresentResult result = _acquire_image(_frame_interval_usec() * 1000, direct_timing, direct_image_index);
+    if (result != PRESENT_OK && paced) pacer.cancel_tick();
+    if (result == PRESENT_OUT_OF_DATE || result == PRESENT_SURFACE_LOST) {
+        // draw_viewport_direct rebuilds it, or tears down if it cannot.
+        swapchain_dirty.store(true);
+        return false;
+    } else if (result != PRESENT_OK) {
+        dropped_frames.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint64_t record_start = _monotonic_ns();
+    FrameContext &frame = frames[ring.get_current_index()];
+    VkCommandBuffer command_buffer = frame.acquire_command_buffer;
+    vkResetCommandBuffer(command_buffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    vkBeginCommandBuffer(command_buffer, &beginInfo);
+
+    // Godot clears the render target, so the old contents can go. The
+    // barrier also orders Godot's later writes after the acquire.
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = swapchain_images[direct_image_index];
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    vkEndCommandBuffer(command_buffer);
+
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &ring.get_current().image_available_semaphore;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &command_buffer;
+
+    // The slot's last acquire submit came before its last present, which
+    // wait_slot saw done, so this does not block.
+    vkWaitForFences(vk_device, 1, &frame.acquire_fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(vk_device, 1, &frame.acquire_fence);
+
+    {
+        // Goes ahead of Godot's own submit for this frame on the same queue.
+        std::lock_guard<std::mutex> queue_lock(*queue_mutex);
+        if (vkQueueSubmit(vk_queue, 1, &submitInfo, frame.acquire_fence) != VK_SUCCESS) {
+            // Nothing will signal it now.
+            vkQueueSubmit(vk_queue, 0, nullptr, frame.acquire_fence);
+            swapchain_dirty.store(true);
+            return false;
+        }
+    }
+    direct_acquire_end_ns = _monotonic_ns();
+    direct_timing.usec[AynThorFrameStats::METRIC_RECORD] = (double)(direct_acquire_end_ns - record_start) / 1000.0;
+    // Godot renders the viewport into the acquired image at the end of this
+    // frame, which is now sure to be presented.
+    if (latency_probe_enabled) direct_touch_ns = latency_probe.take_reflected(Engine::get_singleton()->get_process_frames());
+    direct_acquired = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AynThorRenderer::_direct_present() {
 #ifdef __ANDROID__
-    if (initialized) return;
+    if (!direct_acquired) return;
+    direct_acquired = false;
+
+    uint64_t record_start = _monotonic_ns();
+    VkCommandBuffer command_buffer = ring.get_current().command_buffer;
+    vkResetCommandBuffer(command_buffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    vkBeginCommandBuffer(command_buffer, &beginInfo);
+
+    // Godot leaves a render target's color attachment in
+    // COLOR_ATTACHMENT_OPTIMAL after its last pass. Its submit for this frame
+    // is already queued, so the barrier covers the rendering.
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = swapchain_images[direct_image_index];
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    int capture_slot = -1;
+    if (swapchain_capture_usage && capture.is_active()) {
+        capture_slot = capture.record(command_buffer, swapchain_images[direct_image_index], {width, height}, present_transform_degrees.load(std::memory_order_relaxed), direct_timing.start_ns);
+    }
+    vkEndCommandBuffer(command_buffer);
+
+    uint64_t record_end = _monotonic_ns();
+    direct_timing.usec[AynThorFrameStats::METRIC_RECORD] += (double)(record_end - record_start) / 1000.0;
+    // Leave Godot's own rendering between the two halves out of the total.
+    direct_timing.start_ns += record_start - direct_acquire_end_ns;
+
+    PresentResult result = _submit_and_present(command_buffer, direct_image_index, VK_NULL_HANDLE, capture_slot, false, direct_touch_ns, direct_timing);
+    direct_touch_ns = 0;
+    if (result != PRESENT_OK) {
+        swapchain_dirty.store(true);
+    }
+#endif
+}
+
+void AynThorRenderer::set_rotation_degrees(int p_degrees) {
+    // Quarter turns only; the next frame rebuilds just the swapchain.
+    p_degrees = ((p_degrees % 360 + 360) % 360 + 45) / 90 * 90 % 360;
+    if (p_degrees == rotation_degrees.load()) return;
+    rotation_degrees.store(p_degrees);
+    swapchain_dirty.store(true);
+}
+int AynThorRenderer::get_rotation_degrees() const { return rotation_degrees.load(); }
+AynThorRenderer::RotationPath AynThorRenderer::get_rotation_path() const { return rotation_path.load(); }
+
+void AynThorRenderer::set_compositor_rotation(bool p_enabled) {
+    if (p_enabled == compositor_rotation.load()) return;
+    compositor_rotation.store(p_enabled);
+    swapchain_dirty.store(true);
+}
+bool AynThorRenderer::is_compositor_rotation() const { return compositor_rotation.load(); }
 
-    g_window_mutex.lock();
-    if (!g_second_window) {
-        g_window_mutex.unlock();
+bool AynThorRenderer::is_output_ready() const { return output_ready.load(); }
+
+bool AynThorRenderer::is_window_available() {
+    AynThorDisplayRegistry::Display* display = AynThorDisplayRegistry::get_singleton()->find(_resolve_display_id());
+    return display && display->available.load(std::memory_order_acquire);
+}
+
+Vector2i AynThorRenderer::get_second_screen_size() {
+    AynThorDisplayRegistry::Display* display = AynThorDisplayRegistry::get_singleton()->find(_resolve_display_id());
+    if (!display || !display->available.load(std::memory_order_acquire)) {
+        return Vector2i(0, 0);
+    }
+    uint64_t size = display->size.load(std::memory_order_relaxed);
+    return Vector2i((int32_t)(size >> 32), (int32_t)(size & 0xffffffff));
+}
+
+void AynThorRenderer::_release_touch_ring() {
+    if (!touch_display) return;
+    const void* owner = this;
+    touch_display->touch_owner.compare_exchange_strong(owner, nullptr, std::memory_order_acq_rel);
+    touch_display = nullptr;
+}
+
+void AynThorRenderer::flush_touch_input(Viewport* p_viewport) {
+    int32_t target_display = _resolve_display_id();
+    AynThorDisplayRegistry::Display* display = AynThorDisplayRegistry::get_singleton()->find(target_display);
+    if (display != touch_display) _release_touch_ring();
+    if (!display) return;
+    if (!touch_display) {
+        // The first renderer to flush a display keeps its touches until it
+        // leaves the tree or moves to another display.
+        const void* owner = nullptr;
+        if (!display->touch_owner.compare_exchange_strong(owner, this, std::memory_order_acq_rel)) {
+            if (!touch_owner_warned) {
+                UtilityFunctions::printerr("AynThorPlugin: Another AynThorRenderer already reads the touches of display ", target_display, "; give each renderer its own display_id.");
+                touch_owner_warned = true;
+            }
+            return;
+        }
+        touch_display = display;
+        touch_owner_warned = false;
+    }
+    if (display->touch_ring.is_empty()) return;
+    TouchRing& touch_ring = display->touch_ring;
+
+    Vector2i window_size = get_second_screen_size();
+    int32_t window_w = window_size.x;
+    int32_t window_h = window_size.y;
+
+    TouchSample sample;
+    if (!p_viewport || window_w <= 0 || window_h <= 0) {
+        while (touch_ring.pop(sample)) {}
         return;
     }
-    last_window = g_second_window;
-    g_window_mutex.unlock();
+
+    // Window pixels -> swapchain image pixels: the pre-transform rotates the
+    // image clockwise relative to the window.
+    int transform = present_transform_degrees.load(std::memory_order_relaxed);
+    bool swap_axes = transform == 90 || transform == 270;
+    float image_w = (float)(swap_axes ? window_h : window_w);
+    float image_h = (float)(swap_axes ? window_w : window_h);
+
+    // Image pixels -> viewport pixels, undoing the output rect, the 180
+    // degree flip applied by both the blit and the scaler and the copy
+    // rotation. Direct mode renders upright into the whole image.
+    bool direct = direct_swapchain.load(std::memory_order_relaxed);
+    int copy_rotation = copy_rotation_degrees.load(std::memory_order_relaxed);
+    Vector2 viewport_size = p_viewport->get_visible_rect_size();
+    Rect2 output(0.0f, 0.0f, image_w, image_h);
+#ifdef __ANDROID__
+    if (!direct && scale_mode.load(std::memory_order_relaxed) == SCALE_MODE_INTEGER && scaler.is_ready()) {
+        VkViewport integer_viewport = AynThorScaler::compute_viewport(AynThorScaler::FILTER_INTEGER, {(uint32_t)image_w, (uint32_t)image_h}, (int32_t)viewport_size.x, (int32_t)viewport_size.y, copy_rotation);
+        output = Rect2(integer_viewport.x, integer_viewport.y, integer_viewport.width, integer_viewport.height);
+    }
+#endif
+
+    uint64_t process_frame = Engine::get_singleton()->get_process_frames();
+    while (touch_ring.pop(sample)) {
+        if (sample.pointer_id < 0 || sample.pointer_id >= MAX_TOUCH_POINTERS) continue;
+        TouchPointer &pointer = touch_pointers[sample.pointer_id];
+        if (latency_probe_enabled) latency_probe.touched(process_frame, sample.time_ns);
+
+        float image_x = sample.x;
+        float image_y = sample.y;
+        if (transform == 90) {
+            image_x = (float)window_h - sample.y;
+            image_y = sample.x;
+        } else if (transform == 180) {
+            image_x = (float)window_w - sample.x;
+            image_y = (float)window_h - sample.y;
+        } else if (transform == 270) {
+            image_x = sample.y;
+            image_y = (float)window_w - sample.x;
+        }
+        float u = CLAMP((image_x - output.position.x) / output.size.x, 0.0f, 1.0f);
+        float v = CLAMP((image_y - output.position.y) / output.size.y, 0.0f, 1.0f);
+        if (!direct) AynThorScaler::target_to_source(copy_rotation, u, v, u, v);
+        Vector2 position(u * viewport_size.x, v * viewport_size.y);
+        Vector2 screen_position(sample.x, sample.y);
+
+        if (sample.action == TOUCH_ACTION_MOVE) {
+            if (!pointer.down) continue;
+            if (!pointer.drag_pending) {
+                pointer.drag_pending = true;
+                pointer.drag_relative = Vector2();
+                pointer.drag_screen_relative = Vector2();
+                pointer.drag_start_ns = pointer.time_ns;
+            }
+            pointer.drag_relative += position - pointer.position;
+            pointer.drag_screen_relative += screen_position - pointer.screen_position;
+            pointer.position = position;
+            pointer.screen_position = screen_position;
+            pointer.time_ns = sample.time_ns;
+            continue;
+        }
+
+        bool pressed = sample.action == TOUCH_ACTION_DOWN || sample.action == TOUCH_ACTION_POINTER_DOWN;
+        bool released = sample.action == TOUCH_ACTION_UP || sample.action == TOUCH_ACTION_POINTER_UP || sample.action == TOUCH_ACTION_CANCEL;
+        if (!pressed && !released) continue;
+
+        // Keep drags ordered before the touch change that follows them.
+        _flush_drags(p_viewport);
+
+        pointer.down = pressed;
+        pointer.position = position;
+        pointer.screen_position = screen_position;
+        pointer.time_ns = sample.time_ns;
+
+        Ref<InputEventScreenTouch> touch;
+        touch.instantiate();
+        touch->set_index(sample.pointer_id);
+        touch->set_position(position);
+        touch->set_pressed(pressed);
+        touch->set_canceled(sample.action == TOUCH_ACTION_CANCEL);
+        p_viewport->push_input(touch);
+    }
+
+    _flush_drags(p_viewport);
+}
+
+void AynThorRenderer::_flush_drags(Viewport* p_viewport) {
+    for (int i = 0; i < MAX_TOUCH_POINTERS; i++) {
+        TouchPointer &pointer = touch_pointers[i];
+        if (!pointer.drag_pending) continue;
+        pointer.drag_pending = false;
+
+        float seconds = (float)(pointer.time_ns - pointer.drag_start_ns) / 1e9f;
+        Ref<InputEventScreenDrag> drag;
+        drag.instantiate();
+        drag->set_index(i);
+        drag->set_position(pointer.position);
+        drag->set_relative(pointer.drag_relative);
+        drag->set_screen_relative(pointer.drag_screen_relative);
+        if (seconds > 0.0f) {
+            drag->set_velocity(pointer.drag_relative / seconds);
+            drag->set_screen_velocity(pointer.drag_screen_relative / seconds);
+        }
+        p_viewport->push_input(drag);
+    }
+}
+
+bool AynThorRenderer::_prepare_device() {
+#ifdef __ANDROID__
+    if (device_prepared) return true;
 
     RenderingServer* rs = RenderingServer::get_singleton();
-    if (!rs) return;
+    if (!rs) return false;
     RenderingDevice* rd = rs->get_rendering_device();
-    if (!rd) return;
+    if (!rd) return false;
 
     vk_instance = (VkInstance)rd->get_driver_resource(RenderingDevice::DRIVER_RESOURCE_VULKAN_INSTANCE, RID(), 0);
     vk_device = (VkDevice)rd->get_driver_resource(RenderingDevice::DRIVER_RESOURCE_VULKAN_DEVICE, RID(), 0);
     vk_physical_device = (VkPhysicalDevice)rd->get_driver_resource(RenderingDevice::DRIVER_RESOURCE_VULKAN_PHYSICAL_DEVICE, RID(), 0);
     vk_queue = (VkQueue)rd->get_driver_resource(RenderingDevice::DRIVER_RESOURCE_VULKAN_QUEUE, RID(), 0);
     vk_queue_family_index = (uint32_t)rd->get_driver_resource(RenderingDevice::DRIVER_RESOURCE_VULKAN_QUEUE_FAMILY_INDEX, RID(), 0);
+    queue_mutex = &_shared_queue_mutex(vk_queue);
 
     if (!vk_device || !vk_instance) {
         UtilityFunctions::printerr("AynThorPlugin: Vulkan device or instance is null. Is OpenGL Compatibility mode active? Plugin requires Vulkan.");
-        return;
+        return false;
+    }
+
+    // vkGetDeviceProcAddr only hands these out when Godot enabled the
+    // extension, so a null pointer means the accumulator does the pacing.
+    fp_get_refresh_cycle_duration = (PFN_vkGetRefreshCycleDurationGOOGLE)vkGetDeviceProcAddr(vk_device, "vkGetRefreshCycleDurationGOOGLE");
+    fp_get_past_presentation_timing = (PFN_vkGetPastPresentationTimingGOOGLE)vkGetDeviceProcAddr(vk_device, "vkGetPastPresentationTimingGOOGLE");
+    if (!fp_get_refresh_cycle_duration || !fp_get_past_presentation_timing) {
+        fp_get_refresh_cycle_duration = nullptr;
+        fp_get_past_presentation_timing = nullptr;
+    }
+
+    // Present ids and present wait need VK_KHR_present_id, VK_KHR_present_wait
+    // and both of their features. The entry point only resolves with
+    // present_wait enabled, which requires present_id; Godot does not report
+    // its features, so both have to be there as well. Otherwise neither the
+    // ids nor the waits are used.
+    fp_wait_for_present = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(vk_device, "vkWaitForPresentKHR");
+    if (fp_wait_for_present) {
+        VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features = {};
+        present_wait_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+        VkPhysicalDevicePresentIdFeaturesKHR present_id_features = {};
+        present_id_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+        present_id_features.pNext = &present_wait_features;
+        VkPhysicalDeviceFeatures2 features = {};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &present_id_features;
+        vkGetPhysicalDeviceFeatures2(vk_physical_device, &features);
+        if (!present_id_features.presentId || !present_wait_features.presentWait) {
+            fp_wait_for_present = nullptr;
+        }
     }
 
+    // Without SPIR-V _init_scaler fails and the copy falls back to the blit.
+    std::vector<std::vector<uint32_t>> spirv(AynThorScaler::STAGE_MAX);
+    bool spirv_compiled = true;
+    for (int i = 0; i < AynThorScaler::STAGE_MAX && spirv_compiled; i++) {
+        RenderingDevice::ShaderStage stage = i == AynThorScaler::STAGE_VERTEX ? RenderingDevice::SHADER_STAGE_VERTEX : RenderingDevice::SHADER_STAGE_FRAGMENT;
+
+        Ref<RDShaderSource> shader_source;
+        shader_source.instantiate();
+        shader_source->set_language(RenderingDevice::SHADER_LANGUAGE_GLSL);
+        shader_source->set_stage_source(stage, String(AynThorScaler::get_shader_source((AynThorScaler::ShaderStage)i).c_str()));
+
+        Ref<RDShaderSPIRV> compiled = rd->shader_compile_spirv_from_source(shader_source, true);
+        if (compiled.is_null()) {
+            spirv_compiled = false;
+            break;
+        }
+
+        PackedByteArray bytecode = compiled->get_stage_bytecode(stage);
+        if (bytecode.size() == 0 || bytecode.size() % sizeof(uint32_t) != 0) {
+            UtilityFunctions::printerr("AynThorPlugin: Scaler shader failed to compile: ", compiled->get_stage_compile_error(stage));
+            spirv_compiled = false;
+            break;
+        }
+        spirv[i].resize(bytecode.size() / sizeof(uint32_t));
+        memcpy(spirv[i].data(), bytecode.ptr(), bytecode.size());
+    }
+
+    if (spirv_compiled) scaler_spirv = std::move(spirv);
+
+    PackedByteArray cached = FileAccess::get_file_as_bytes(PIPELINE_CACHE_PATH);
+    if (cached.size() > 0) {
+        scaler_cache_data.assign(cached.ptr(), cached.ptr() + cached.size());
+    }
+
+    device_prepared = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AynThorRenderer::_init_vulkan() {
+#ifdef __ANDROID__
+    if (initialized || !device_prepared) return;
+
+    // Our own reference keeps the window alive until _cleanup_vulkan, even
+    // if the plugin replaces or removes it in the meantime.
+    AynThorDisplayRegistry* registry = AynThorDisplayRegistry::get_singleton();
+    int32_t target_display = _resolve_display_id();
+    last_window = registry->acquire_window(target_display, window_generation);
+    if (!last_window) return;
+    active_display = registry->find(target_display);
+    active_display_id = target_display;
+
     VkAndroidSurfaceCreateInfoKHR createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_ANDROID_SURFACE_CREATE_INFO_KHR;
     createInfo.window = (ANativeWindow*)last_window;
 
     VkResult res = vkCreateAndroidSurfaceKHR(vk_instance, &createInfo, nullptr, &surface);
     if (res != VK_SUCCESS) {
+        _cleanup_vulkan();
         return;
     }
 
+    // From here on _cleanup_vulkan unwinds whatever was created.
+    initialized = true;
+
     VkCommandPoolCreateInfo poolInfo = {};
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     poolInfo.queueFamilyIndex = vk_queue_family_index;
     poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
     if (vkCreateCommandPool(vk_device, &poolInfo, nullptr, &command_pool) != VK_SUCCESS) {
+        _cleanup_vulkan();
+        return;
+    }
+
+    ring.init(vk_physical_device, vk_device);
+    if (!_create_frame_contexts()) {
+        _cleanup_vulkan();
         return;
     }
 
+    ring.create_timestamps(vk_queue_family_index);
+    capture.init_gpu(vk_physical_device, vk_device);
+
+    copy_rotation_unavailable = !_init_scaler();
+    if (copy_rotation_unavailable) {
+        UtilityFunctions::printerr("AynThorPlugin: Shader scaling unavailable, falling back to blit.");
+    }
+
+    surface_generation = active_display->surface_generation.load(std::memory_order_acquire);
+    swapchain_dirty.store(false);
+    _create_swapchain(VK_NULL_HANDLE);
+#endif
+}
+
+bool AynThorRenderer::_init_scaler() {
+#ifdef __ANDROID__
+    if (scaler_spirv.empty()) return false;
+    return scaler.init(vk_device, scaler_spirv, scaler_cache_data, MAX_FRAMES_IN_FLIGHT * SOURCE_SLOTS);
+#else
+    return false;
+#endif
+}
+
+void AynThorRenderer::_save_pipeline_cache() {
+#ifdef __ANDROID__
+    std::vector<uint8_t> data = scaler.get_cache_data();
+    if (data.empty()) return;
+    // The next init in this run starts from it too.
+    scaler_cache_data = data;
+
+    Ref<FileAccess> file = FileAccess::open(PIPELINE_CACHE_PATH, FileAccess::WRITE);
+    if (file.is_null()) return;
+
+    PackedByteArray bytes;
+    bytes.resize((int64_t)data.size());
+    memcpy(bytes.ptrw(), data.data(), data.size());
+    file->store_buffer(bytes);
+#endif
+}
+
+bool AynThorRenderer::_create_frame_contexts() {
+#ifdef __ANDROID__
+    if (!ring.create_slots(command_pool, (uint32_t)frames_in_flight)) return false;
+    frames.resize(ring.get_slot_count());
+
+    // On top of the ring's present command buffer, each slot gets a
+    // direct-mode acquire one.
+    std::vector<VkCommandBuffer> command_buffers(frames.size());
     VkCommandBufferAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.commandPool = command_pool;
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = 1;
+    allocInfo.commandBufferCount = (uint32_t)command_buffers.size();
 
-    vkAllocateCommandBuffers(vk_device, &allocInfo, &command_buffer);
-
-    VkSemaphoreCreateInfo semaphoreInfo = {};
-    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    if (vkAllocateCommandBuffers(vk_device, &allocInfo, command_buffers.data()) != VK_SUCCESS) {
+        frames.clear();
+        ring.destroy_slots();
+        return false;
+    }
 
     VkFenceCreateInfo fenceInfo = {};
     fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    vkCreateSemaphore(vk_device, &semaphoreInfo, nullptr, &image_available_semaphore);
-    vkCreateSemaphore(vk_device, &semaphoreInfo, nullptr, &render_finished_semaphore);
-    vkCreateFence(vk_device, &fenceInfo, nullptr, &in_flight_fence);
+    for (size_t i = 0; i < frames.size(); i++) {
+        FrameContext &frame = frames[i];
+        frame.acquire_command_buffer = command_buffers[i];
+        if (vkCreateFence(vk_device, &fenceInfo, nullptr, &frame.acquire_fence) != VK_SUCCESS) {
+            _destroy_frame_contexts();
+            return false;
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AynThorRenderer::_destroy_frame_contexts() {
+#ifdef __ANDROID__
+    if (!vk_device) return;
 
-    _create_swapchain();
+    _wait_own_work();
+    _release_copy_cache();
 
-    initialized = true;
+    for (FrameContext &frame : frames) {
+        if (frame.acquire_command_buffer && command_pool) vkFreeCommandBuffers(vk_device, command_pool, 1, &frame.acquire_command_buffer);
+        if (frame.acquire_fence) vkDestroyFence(vk_device, frame.acquire_fence, nullptr);
+    }
+    frames.clear();
+    ring.destroy_slots();
+    // A held image was acquired against a semaphore that is gone now; it is
+    // released by rebuilding the swapchain.
+    if (image_acquired) {
+        image_acquired = false;
+        swapchain_dirty.store(true);
+    }
+#endif
+}
+
+void AynThorRenderer::_wait_own_work() {
+#ifdef __ANDROID__
+    // Only our own submissions are waited for; the rest of Godot's queue can
+    // keep going. Godot's rendering into our images in direct mode comes
+    // between a slot's acquire submit and its present submit.
+    std::vector<VkFence> fences;
+    for (const FrameContext &frame : frames) {
+        if (frame.acquire_fence) fences.push_back(frame.acquire_fence);
+    }
+    if (!fences.empty()) {
+        vkWaitForFences(vk_device, (uint32_t)fences.size(), fences.data(), VK_TRUE, UINT64_MAX);
+    }
+    ring.wait_slots(UINT64_MAX);
+    capture.retire_all();
+#endif
+}
+
+bool AynThorRenderer::_recreate_swapchain() {
+#ifdef __ANDROID__
+    // Keeps the surface, command pool and ring; only the swapchain and the
+    // views that point into it are rebuilt.
+    _wait_own_work();
+    _release_copy_cache();
+    scaler.release_target();
+    _destroy_direct_textures();
+    // An image still held goes away with the swapchain it came from.
+    image_acquired = false;
+
+    VkSwapchainKHR old_swapchain = swapchain;
+    swapchain = VK_NULL_HANDLE;
+    last_present_id = 0;
+    swapchain_recreations.fetch_add(1, std::memory_order_relaxed);
+    _create_swapchain(old_swapchain);
+
+    // The old swapchain is retired even when creation fails. Its last
+    // presents may still be on screen, see AynThorPresentRing::acquire.
+    ring.retire_swapchain(old_swapchain);
+    return swapchain != VK_NULL_HANDLE;
+#else
+    return false;
 #endif
 }
 
-void AynThorRenderer::_create_swapchain() {
 #ifdef __ANDROID__
+void AynThorRenderer::_create_swapchain(VkSwapchainKHR p_old_swapchain) {
     if (!surface) return;
 
-    int32_t window_w = ANativeWindow_getWidth((ANativeWindow*)last_window);
-    int32_t window_h = ANativeWindow_getHeight((ANativeWindow*)last_window);
+    // The size nativeSurfaceChanged reported, else the window's own.
+    uint64_t size = active_display ? active_display->size.load(std::memory_order_relaxed) : 0;
+    int32_t window_w = (int32_t)(size >> 32);
+    int32_t window_h = (int32_t)(uint32_t)size;
+    if (window_w <= 0 || window_h <= 0) {
+        window_w = ANativeWindow_getWidth((ANativeWindow*)last_window);
+        window_h = ANativeWindow_getHeight((ANativeWindow*)last_window);
+    }
 
     VkSurfaceCapabilitiesKHR capabilities;
     vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vk_physical_device, surface, &capabilities);
@@ -146,14 +1621,35 @@ void AynThorRenderer::_create_swapchain() {
         vkGetPhysicalDeviceSurfaceFormatsKHR(vk_physical_device, surface, &formatCount, formats.data());
     }
 
+    // Candidates in order of preference. A 16-bit panel format halves what
+    // the copy writes and the compositor reads; the copy needs to blit or
+    // render into it.
+    std::vector<VkFormat> candidates;
+    SwapchainFormat format_policy = swapchain_format.load();
+    if (format_policy == SWAPCHAIN_FORMAT_LOW_BANDWIDTH) {
+        candidates = {VK_FORMAT_R5G6B5_UNORM_PACK16, VK_FORMAT_B5G6R5_UNORM_PACK16};
+    } else if (format_policy == SWAPCHAIN_FORMAT_HIGH_PRECISION) {
+        candidates = {VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_FORMAT_A2R10G10B10_UNORM_PACK32};
+    }
+    candidates.push_back(VK_FORMAT_R8G8B8A8_UNORM);
+    candidates.push_back(VK_FORMAT_B8G8R8A8_UNORM);
+
     swapchain_image_format = VK_FORMAT_R8G8B8A8_UNORM;
     VkColorSpaceKHR target_color_space = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
     bool format_found = false;
-    for (const auto& format : formats) {
-        if (format.format == VK_FORMAT_R8G8B8A8_UNORM && format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
-            format_found = true;
-            break;
+    for (VkFormat candidate : candidates) {
+        VkFormatProperties properties = {};
+        vkGetPhysicalDeviceFormatProperties(vk_physical_device, candidate, &properties);
+        VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+        if ((properties.optimalTilingFeatures & needed) != needed) continue;
+        for (const auto& format : formats) {
+            if (format.format == candidate && format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+                swapchain_image_format = candidate;
+                format_found = true;
+                break;
+            }
         }
+        if (format_found) break;
     }
     if (!format_found && formatCount > 0) {
         swapchain_image_format = formats[0].format;
@@ -167,25 +1663,64 @@ void AynThorRenderer::_create_swapchain() {
         vkGetPhysicalDeviceSurfacePresentModesKHR(vk_physical_device, surface, &presentModeCount, presentModes.data());
     }
 
+    PresentModePolicy policy = present_mode_policy.load();
+    VkPresentModeKHR preferred_present_mode = VK_PRESENT_MODE_FIFO_KHR;
+    if (policy == PRESENT_MODE_LOW_LATENCY) preferred_present_mode = VK_PRESENT_MODE_MAILBOX_KHR;
+    else if (policy == PRESENT_MODE_ADAPTIVE) preferred_present_mode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+
+    // FIFO is the only mode every implementation has to support.
     VkPresentModeKHR target_present_mode = VK_PRESENT_MODE_FIFO_KHR;
     for (const auto& mode : presentModes) {
-        if (mode == VK_PRESENT_MODE_MAILBOX_KHR) {
+        if (mode == preferred_present_mode) {
             target_present_mode = mode;
             break;
         }
     }
 
-    VkSurfaceTransformFlagBitsKHR target_transform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
-    if (rotation_degrees == 90) target_transform = VK_SURFACE_TRANSFORM_ROTATE_90_BIT_KHR;
-    else if (rotation_degrees == 180) target_transform = VK_SURFACE_TRANSFORM_ROTATE_180_BIT_KHR;
-    else if (rotation_degrees == 270) target_transform = VK_SURFACE_TRANSFORM_ROTATE_270_BIT_KHR;
-
-    bool transform_supported = (capabilities.supportedTransforms & target_transform);
+    int rotation = rotation_degrees.load();
+    VkImageUsageFlags direct_usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    bool use_direct = direct_frames && !direct_unavailable && (capabilities.supportedUsageFlags & direct_usage) == direct_usage &&
+            (swapchain_image_format == VK_FORMAT_R8G8B8A8_UNORM || swapchain_image_format == VK_FORMAT_B8G8R8A8_UNORM);
+    if (use_direct) {
+        // Godot renders the viewport upright instead of through the copy
+        // path's 180 degree flip, so the pre-transform makes up for it.
+        int direct_rotation = (rotation + 180) % 360;
+        if (capabilities.supportedTransforms & _transform_for_degrees(direct_rotation)) {
+            rotation = direct_rotation;
+        } else {
+            use_direct = false;
+        }
+    }
+    // The buffer keeps the surface's own transform, so the compositor has
+    // nothing to undo, and the copy rotates the rest. Any other
+    // pre-transform makes the compositor rotate every frame, so it is only
+    // used by direct mode, which has no copy, on request, or when the copy
+    // cannot rotate.
+    VkSurfaceTransformFlagBitsKHR target_transform = capabilities.currentTransform;
+    int pre_degrees = MAX(_degrees_for_transform(target_transform), 0);
+    bool pre_transform_rotates = use_direct || compositor_rotation.load() || copy_rotation_unavailable;
+    if (rotation != pre_degrees && pre_transform_rotates && (capabilities.supportedTransforms & _transform_for_degrees(rotation))) {
+        target_transform = _transform_for_degrees(rotation);
+        pre_degrees = rotation;
+    }
+    int copy_rotation = (rotation - pre_degrees + 360) % 360;
+    if (copy_rotation != 0 && copy_rotation_unavailable) {
+        UtilityFunctions::printerr("AynThorPlugin: The surface has no pre-transform for ", rotation, " degrees and the copy cannot rotate, showing the second screen unrotated.");
+        copy_rotation = 0;
+        rotation_path.store(ROTATION_PATH_NONE);
+    } else if (copy_rotation != 0) {
+        rotation_path.store(ROTATION_PATH_COPY);
+    } else {
+        rotation_path.store(target_transform == capabilities.currentTransform ? ROTATION_PATH_PRE_TRANSFORM : ROTATION_PATH_COMPOSITOR);
+    }
+    present_transform_degrees.store(pre_degrees);
+    copy_rotation_degrees.store(copy_rotation);
 
     VkSwapchainCreateInfoKHR createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
     createInfo.surface = surface;
-    createInfo.minImageCount = capabilities.minImageCount + 1;
+    int image_count = swapchain_image_count.load();
+    createInfo.minImageCount = image_count > 0 ? MAX((uint32_t)image_count, capabilities.minImageCount) : capabilities.minImageCount + 1;
     if (capabilities.maxImageCount > 0 && createInfo.minImageCount > capabilities.maxImageCount) {
         createInfo.minImageCount = capabilities.maxImageCount;
     }
@@ -193,28 +1728,27 @@ void AynThorRenderer::_create_swapchain() {
     createInfo.imageColorSpace = target_color_space;
     createInfo.imageArrayLayers = 1;
     createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (use_direct) {
+        createInfo.imageUsage |= direct_usage;
+    }
+    swapchain_capture_usage = capture.is_active() && (capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+    if (swapchain_capture_usage) {
+        createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
     createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = target_present_mode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    createInfo.oldSwapchain = p_old_swapchain;
 
-    if (transform_supported) {
-        createInfo.preTransform = target_transform;
-        if (rotation_degrees == 90 || rotation_degrees == 270) {
-            width = window_h;
-            height = window_w;
-        } else {
-            width = window_w;
-            height = window_h;
-        }
+    createInfo.preTransform = target_transform;
+    if (pre_degrees == 90 || pre_degrees == 270) {
+        createInfo.imageExtent = {(uint32_t)window_h, (uint32_t)window_w};
     } else {
-        createInfo.preTransform = capabilities.currentTransform;
-        width = window_w;
-        height = window_h;
+        createInfo.imageExtent = {(uint32_t)window_w, (uint32_t)window_h};
     }
-
-    createInfo.imageExtent = {(uint32_t)width, (uint32_t)height};
+    width.store(createInfo.imageExtent.width);
+    height.store(createInfo.imageExtent.height);
 
     VkResult res = vkCreateSwapchainKHR(vk_device, &createInfo, nullptr, &swapchain);
     if (res != VK_SUCCESS) {
@@ -225,191 +1759,753 @@ void AynThorRenderer::_create_swapchain() {
     vkGetSwapchainImagesKHR(vk_device, swapchain, &imageCount, nullptr);
     swapchain_images.resize(imageCount);
     vkGetSwapchainImagesKHR(vk_device, swapchain, &imageCount, swapchain_images.data());
-#endif
+    ring.swapchain_created(surface, imageCount, capabilities);
+
+    swapchain_vk_format.store((int)swapchain_image_format);
+    swapchain_images_created.store(imageCount);
+    swapchain_image_bytes.store((uint64_t)createInfo.imageExtent.width * createInfo.imageExtent.height * _format_bytes_per_pixel(swapchain_image_format));
+
+    if (fp_get_refresh_cycle_duration) {
+        VkRefreshCycleDurationGOOGLE refresh_cycle = {};
+        if (fp_get_refresh_cycle_duration(vk_device, swapchain, &refresh_cycle) == VK_SUCCESS) {
+            swapchain_refresh_period_ns.store(refresh_cycle.refreshDuration, std::memory_order_relaxed);
+        }
+    }
+
+    if (use_direct) {
+        if (_create_direct_textures()) {
+            direct_swapchain.store(true);
+            return;
+        }
+        // Rebuilt for the copy path before the next frame.
+        UtilityFunctions::printerr("AynThorPlugin: Could not wrap the swapchain for direct mode, using the copy path.");
+        direct_unavailable = true;
+        swapchain_dirty.store(true);
+    }
+    if (!scaler.set_target(swapchain_image_format, swapchain_images, createInfo.imageExtent, copy_rotation) && copy_rotation != 0) {
+        // The blit cannot rotate; rebuilt to rotate with the pre-transform.
+        UtilityFunctions::printerr("AynThorPlugin: The copy pass cannot rotate, using a pre-transform.");
+        copy_rotation_unavailable = true;
+        copy_rotation_degrees.store(0);
+        rotation_path.store(ROTATION_PATH_NONE);
+        swapchain_dirty.store(true);
+    }
 }
+#endif
 
 void AynThorRenderer::draw_viewport_texture(RID texture_rid) {
 #ifdef __ANDROID__
-    if (target_fps > 0) {
-        uint64_t current_time = Time::get_singleton()->get_ticks_usec();
-        if ((current_time - last_frame_time_usec) < (1000000 / target_fps)) {
+    // Skips the frame while the setup thread builds the output.
+    std::unique_lock<std::mutex> output_lock(output_mutex, std::try_to_lock);
+    if (!output_lock.owns_lock()) return;
+
+    _set_direct_frames(false);
+    _update_pacing();
+    // Under VSync scheduling the pacer already picked this frame. Otherwise
+    // the slot is given back whenever the frame is not presented after all,
+    // so skips and failures do not push the next frame a whole interval out.
+    bool paced = update_policy != UPDATE_POLICY_VSYNC;
+    if (paced && !pacer.tick(_monotonic_ns())) return;
+
+    SourceFrame source;
+    if (!_prepare_output(setup_thread.joinable()) || !_resolve_source(texture_rid, source)) {
+        if (paced) pacer.cancel_tick();
+        return;
+    }
+    _resolve_layers(source);
+
+    if (dirty_tracking && !_take_damage(source)) {
+        if (paced) pacer.cancel_tick();
+        skipped_frames.fetch_add(1, std::memory_order_relaxed);
+        // Nothing else would hand finished captures to the writer.
+        if (!present_thread_running.load(std::memory_order_relaxed)) capture.poll();
+        return;
+    }
+
+    if (present_thread_running.load(std::memory_order_relaxed)) {
+        // The present thread only paces and acquires. The copy is submitted
+        // and presented here, on the thread that submits Godot's frames, so
+        // it follows the render of the source in queue order and runs while
+        // Godot still holds the source.
+        FramePolicy policy = frame_policy.load(std::memory_order_relaxed);
+        if (!_wait_acquired_image(policy == FRAME_POLICY_BLOCK ? _frame_interval_usec() : 0)) {
+            // No image in time: the next frame repaints what this one changed.
+            // Blocking counts the miss as late, since it waited for it.
+            if (paced) pacer.cancel_tick();
+            content_invalidated.store(true);
+            if (policy == FRAME_POLICY_DROP) {
+                dropped_frames.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                late_frames.fetch_add(1, std::memory_order_relaxed);
+            }
             return;
         }
-        last_frame_time_usec = current_time;
     }
 
-    g_window_mutex.lock();
-    void* current_window = g_second_window;
-    g_window_mutex.unlock();
+    PresentResult result = _present_source(source, UINT64_MAX);
+    _return_acquired_image();
+    if (result != PRESENT_OK) {
+        if (paced) pacer.cancel_tick();
+        content_invalidated.store(true);
+    }
+    if (result == PRESENT_SURFACE_LOST) {
+        _cleanup_vulkan();
+    }
+#endif
+}
+
+// Engine frame at whose end the texture drawn now was rendered. Without
+// schedule_viewports() the second viewport renders every frame.
+uint64_t AynThorRenderer::_second_rendered_frame() const {
+    uint64_t frame = Engine::get_singleton()->get_process_frames();
+    if (last_schedule_ns == 0) return frame > 0 ? frame - 1 : 0;
+    return second_render_frame < frame ? second_render_frame : previous_second_render_frame;
+}
+
+bool AynThorRenderer::_take_damage(SourceFrame& r_frame) {
+#ifdef __ANDROID__
+    bool full = damage_full || content_invalidated.exchange(false) || swapchain_dirty.load();
+
+    uint64_t generation = active_display ? active_display->surface_generation.load(std::memory_order_acquire) : 0;
+    if (generation != presented_surface_generation) {
+        presented_surface_generation = generation;
+        full = true;
+    }
+    if ((uint64_t)r_frame.image != last_source_image || r_frame.width != last_source_width || r_frame.height != last_source_height) {
+        last_source_image = (uint64_t)r_frame.image;
+        last_source_width = r_frame.width;
+        last_source_height = r_frame.height;
+        full = true;
+    }
+    if (r_frame.layers_version != last_layers_version) {
+        last_layers_version = r_frame.layers_version;
+        full = true;
+    }
+    if (!full && !damage_pending) return false;
+
+    // Presents always cover the whole image; the rect only decides whether
+    // anything visible changed.
+    bool visible = full || damage_rect.intersects(Rect2i(0, 0, r_frame.width, r_frame.height));
+    damage_pending = false;
+    damage_full = false;
+    damage_rect = Rect2i();
+    return visible;
+#else
+    return false;
+#endif
+}
+
+// Called with output_mutex held. With p_async the setup thread does any
+// tear-down and init, and the caller skips frames until it is done.
+bool AynThorRenderer::_prepare_output(bool p_async) {
+#ifdef __ANDROID__
+    int32_t target_display = _resolve_display_id();
+    AynThorDisplayRegistry::Display* display = AynThorDisplayRegistry::get_singleton()->find(target_display);
 
-    if (!current_window) {
+    if (!display || !display->available.load(std::memory_order_acquire)) {
         if (initialized) _cleanup_vulkan();
-        return;
+        return false;
     }
 
-    if (initialized && current_window != last_window) {
+    // A new window, another display or a lost worker all need a fresh surface.
+    bool stale = initialized && (target_display != active_display_id || display->window_generation.load(std::memory_order_acquire) != window_generation || present_thread_lost.load(std::memory_order_acquire));
+    if (p_async && (stale || !initialized)) {
+        _request_setup();
+        return false;
+    }
+    if (stale) {
         _cleanup_vulkan();
     }
 
     if (!initialized) {
+        if (!_prepare_device()) return false;
         _init_vulkan();
-        if (!initialized) return;
+        if (!initialized) return false;
+        if (threaded_present && !direct_frames) _start_present_thread();
+        if (swapchain && !output_ready.exchange(true)) {
+            call_deferred("emit_signal", "output_ready");
+        }
+    }
+
+    // A missing swapchain is rebuilt by whichever thread presents next.
+    return !frames.empty();
+#else
+    return false;
+#endif
+}
+
+void AynThorRenderer::SetupListener::window_changed(int32_t p_display_id) {
+    renderer->_request_setup();
+}
+
+void AynThorRenderer::_request_setup() {
+    std::lock_guard<std::mutex> lock(setup_wake_mutex);
+    setup_requested = true;
+    setup_wake_cv.notify_one();
+}
+
+void AynThorRenderer::_start_setup_thread() {
+#ifdef __ANDROID__
+    if (setup_thread.joinable()) return;
+    setup_thread_running = true;
+    // Whatever window is already there gets set up straight away.
+    setup_requested = true;
+    setup_thread = std::thread(&AynThorRenderer::_setup_thread_loop, this);
+    AynThorDisplayRegistry::get_singleton()->add_listener(&setup_listener);
+#endif
+}
+
+void AynThorRenderer::_stop_setup_thread() {
+    if (!setup_thread.joinable()) return;
+    AynThorDisplayRegistry::get_singleton()->remove_listener(&setup_listener);
+    {
+        std::lock_guard<std::mutex> lock(setup_wake_mutex);
+        setup_thread_running = false;
     }
+    setup_wake_cv.notify_one();
+    setup_thread.join();
+}
 
-    vkWaitForFences(vk_device, 1, &in_flight_fence, VK_TRUE, UINT64_MAX);
+void AynThorRenderer::_setup_thread_loop() {
+    std::unique_lock<std::mutex> lock(setup_wake_mutex);
+    while (true) {
+        setup_wake_cv.wait(lock, [this]() { return setup_requested || !setup_thread_running; });
+        if (!setup_thread_running) break;
+        setup_requested = false;
+        lock.unlock();
+        {
+            // Direct mode is set up on the main thread, see draw_viewport_direct.
+            std::lock_guard<std::mutex> output_lock(output_mutex);
+            if (!direct_frames) _prepare_output(false);
+        }
+        lock.lock();
+    }
+}
 
+bool AynThorRenderer::_resolve_source(RID p_texture_rid, SourceFrame& r_frame) {
+#ifdef __ANDROID__
     RenderingServer* rs = RenderingServer::get_singleton();
-    RenderingDevice* rd = rs->get_rendering_device();
-    RID rd_texture_rid = rs->texture_get_rd_texture(texture_rid);
+    RID rd_texture_rid = rs->texture_get_rd_texture(p_texture_rid);
+
+    if (!rd_texture_rid.is_valid()) return false;
+    for (uint32_t slot = 0; slot < SOURCE_SLOTS; slot++) {
+        if (rd_texture_rid == cached_source_rd_textures[slot]) {
+            last_source_slot = slot;
+            r_frame = cached_sources[slot];
+            return true;
+        }
+    }
+    // Replaces the entry that was not used last.
+    uint32_t slot = (last_source_slot + 1) % SOURCE_SLOTS;
+    cached_source_rd_textures[slot] = RID();
+    r_frame.slot = slot;
+
+    if (!_describe_texture(rd_texture_rid, r_frame.image, r_frame.view, r_frame.state, r_frame.width, r_frame.height)) return false;
+    Ref<RDTextureFormat> texture_format = RenderingServer::get_singleton()->get_rendering_device()->texture_get_format(rd_texture_rid);
+    r_frame.bytes_per_pixel = _data_format_bytes_per_pixel(texture_format->get_format());
+
+    cached_source_rd_textures[slot] = rd_texture_rid;
+    cached_sources[slot] = r_frame;
+    last_source_slot = slot;
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef __ANDROID__
+bool AynThorRenderer::_describe_texture(RID p_rd_texture_rid, VkImage& r_image, VkImageView& r_view, AynThorImageState& r_state, int32_t& r_width, int32_t& r_height) {
+    RenderingDevice* rd = RenderingServer::get_singleton()->get_rendering_device();
+
+    r_image = (VkImage)rd->get_driver_resource(RenderingDevice::DRIVER_RESOURCE_VULKAN_IMAGE, p_rd_texture_rid, 0);
+    if (!r_image) return false;
+    r_view = (VkImageView)rd->get_driver_resource(RenderingDevice::DRIVER_RESOURCE_VULKAN_IMAGE_VIEW, p_rd_texture_rid, 0);
+
+    Ref<RDTextureFormat> texture_format = rd->texture_get_format(p_rd_texture_rid);
+    if (texture_format.is_null()) return false;
+
+    r_width = (int32_t)texture_format->get_width();
+    r_height = (int32_t)texture_format->get_height();
+
+    // Godot does not expose the image's current layout, so this is assumed
+    // from the usage: a colour attachment as its render pass leaves it,
+    // anything else as a sampled texture. A texture Godot last used some
+    // other way is copied from, and handed back in, the wrong layout.
+    if (texture_format->get_usage_bits() & RenderingDevice::TEXTURE_USAGE_COLOR_ATTACHMENT_BIT) {
+        r_state = AynThorImageState();
+    } else {
+        r_state.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        r_state.stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        r_state.access = VK_ACCESS_SHADER_READ_BIT;
+    }
+    return r_width > 0 && r_height > 0;
+}
+#endif
+
+void AynThorRenderer::_resolve_layers(SourceFrame& r_frame) {
+#ifdef __ANDROID__
+    RenderingServer* rs = RenderingServer::get_singleton();
+    uint32_t count = 0;
+    for (LayerEntry &layer : layers) {
+        // A resized or replaced texture gets a new RD texture.
+        RID rd_texture_rid = layer.texture.is_valid() ? rs->texture_get_rd_texture(layer.texture) : RID();
+        if (layer.stale || rd_texture_rid != layer.rd_texture) {
+            AynThorScaler::Layer &frame = layer.frame;
+            layer.rd_texture = rd_texture_rid;
+            layer.resolved = rd_texture_rid.is_valid() && _describe_texture(rd_texture_rid, frame.image, frame.view, frame.state, frame.width, frame.height) && frame.view;
+            layer.stale = false;
+            layers_version++;
+        }
+        if (!layer.resolved || count >= AynThorScaler::MAX_LAYERS) continue;
+
+        // Empty rects stand for the whole layer and the whole source.
+        AynThorScaler::Layer &out = r_frame.layers[count++];
+        out = layer.frame;
+        Rect2i source = layer.source_rect.has_area() ? layer.source_rect : Rect2i(0, 0, out.width, out.height);
+        Rect2i dest = layer.dest_rect.has_area() ? layer.dest_rect : Rect2i(0, 0, r_frame.width, r_frame.height);
+        out.src_rect[0] = (float)source.position.x;
+        out.src_rect[1] = (float)source.position.y;
+        out.src_rect[2] = (float)source.size.x;
+        out.src_rect[3] = (float)source.size.y;
+        out.dst_rect[0] = (float)dest.position.x;
+        out.dst_rect[1] = (float)dest.position.y;
+        out.dst_rect[2] = (float)dest.size.x;
+        out.dst_rect[3] = (float)dest.size.y;
+        out.opacity = layer.opacity;
+    }
+    r_frame.layer_count = count;
+    r_frame.layers_version = layers_version;
+#endif
+}
+
+uint64_t AynThorRenderer::_frame_interval_usec() const {
+    uint64_t interval = pacer.get_interval_ns();
+    if (interval == 0) interval = pacer.get_refresh_period_ns();
+    return interval / 1000;
+}
+
+void AynThorRenderer::_update_pacing() {
+    // Prefer what the swapchain reports, then what the Display said.
+    uint64_t period = swapchain_refresh_period_ns.load(std::memory_order_relaxed);
+    if (period == 0) {
+        AynThorDisplayRegistry::Display* display = AynThorDisplayRegistry::get_singleton()->find(_resolve_display_id());
+        float refresh_rate = display ? display->refresh_rate.load(std::memory_order_relaxed) : 0.0f;
+        if (refresh_rate > 1.0f) period = (uint64_t)(1e9 / refresh_rate);
+    }
+    if (period != 0 && period != pacer.get_refresh_period_ns()) {
+        pacer.set_refresh_period(period);
+        pacing_dirty.store(true);
+    }
+    if (pacing_dirty.exchange(false)) {
+        pacer.configure(target_fps.load(), refresh_divisor.load());
+    }
+}
+
+void AynThorRenderer::_observe_presentation() {
+#ifdef __ANDROID__
+    if (!fp_get_past_presentation_timing) return;
+
+    VkPastPresentationTimingGOOGLE timings[8];
+    uint64_t latest = 0;
+    VkResult res;
+    do {
+        uint32_t count = 8;
+        res = fp_get_past_presentation_timing(vk_device, swapchain, &count, timings);
+        if (res != VK_SUCCESS && res != VK_INCOMPLETE) return;
+        for (uint32_t i = 0; i < count; i++) {
+            latest = MAX(latest, timings[i].actualPresentTime);
+            latency_probe.presented(timings[i].presentID, timings[i].actualPresentTime, AynThorLatencyProbe::SOURCE_DISPLAY_TIMING);
+        }
+    } while (res == VK_INCOMPLETE);
 
-    if (!rd_texture_rid.is_valid()) return;
+    if (latest != 0) pacer.anchor(latest);
+#endif
+}
 
-    VkImage source_image = (VkImage)rd->get_driver_resource(RenderingDevice::DRIVER_RESOURCE_VULKAN_IMAGE, rd_texture_rid, 0);
-    if (!source_image) return;
+bool AynThorRenderer::_wait_for_display(uint64_t p_timeout_ns) {
+#ifdef __ANDROID__
+    if (!fp_wait_for_present || last_present_id == 0 || !swapchain) return false;
+    if (fp_wait_for_present(vk_device, swapchain, last_present_id, p_timeout_ns) != VK_SUCCESS) return false;
+    // Returns right after the frame reached the panel, which is as close to
+    // its vsync as we can observe without display timing.
+    uint64_t now = _monotonic_ns();
+    pacer.anchor(now);
+    latency_probe.presented(last_present_id, now, AynThorLatencyProbe::SOURCE_PRESENT_WAIT);
+    return true;
+#else
+    return false;
+#endif
+}
 
+AynThorRenderer::PresentResult AynThorRenderer::_present_source(const SourceFrame& p_frame, uint64_t p_timeout_ns) {
+#ifdef __ANDROID__
+    AynThorFrameStats::FrameTiming timing;
     uint32_t imageIndex;
-    VkResult res = vkAcquireNextImageKHR(vk_device, swapchain, UINT64_MAX, image_available_semaphore, VK_NULL_HANDLE, &imageIndex);
+    if (image_acquired) {
+        // From the present thread, or left over from before it stopped.
+        imageIndex = acquired_image_index;
+        timing = acquired_timing;
+        // Waiting for the game loop is not part of this frame's CPU time.
+        timing.start_ns = _monotonic_ns();
+    } else {
+        PresentResult result = _acquire_next(p_timeout_ns, timing, imageIndex);
+        if (result != PRESENT_OK) return result;
+    }
 
-    if (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_ERROR_SURFACE_LOST_KHR) {
-        _cleanup_vulkan();
-        return;
-    } else if (res != VK_SUCCESS && res != VK_SUBOPTIMAL_KHR) {
-        return;
+    // The frame is sure to be presented only now, past the damage check,
+    // pacing and the acquire, so only now does it claim its touch.
+    int64_t touch_ns = latency_probe_enabled ? latency_probe.take_reflected(_second_rendered_frame()) : 0;
+
+    VkCommandBuffer command_buffer = ring.get_current().command_buffer;
+    uint64_t record_start = _monotonic_ns();
+
+    int capture_slot = -1;
+    if (swapchain_capture_usage && capture.is_active()) {
+        // Capture staging changes every frame, so these are recorded fresh.
+        _record_copy(command_buffer, p_frame, imageIndex);
+        // Recorded after the end timestamp so gpu_copy stays the copy alone.
+        capture_slot = capture.record(command_buffer, swapchain_images[imageIndex], {width, height}, present_transform_degrees.load(std::memory_order_relaxed), timing.start_ns);
+        vkEndCommandBuffer(command_buffer);
+    } else {
+        command_buffer = _cached_copy(p_frame, imageIndex);
     }
+    timing.usec[AynThorFrameStats::METRIC_RECORD] = (double)(_monotonic_ns() - record_start) / 1000.0;
+
+    return _submit_and_present(command_buffer, imageIndex, ring.get_current().image_available_semaphore, capture_slot, ring.has_timestamps(), touch_ns, timing);
+#else
+    return PRESENT_FAILED;
+#endif
+}
+
+#ifdef __ANDROID__
+// Whether the copy goes through the scaler, and with which filter.
+bool AynThorRenderer::_scaler_filter(const SourceFrame& p_frame, AynThorScaler::Filter& r_filter) const {
+    if (!scaler.is_ready() || !p_frame.view) return false;
+    ScaleMode mode = scale_mode.load(std::memory_order_relaxed);
+    if (mode != SCALE_MODE_BLIT) {
+        r_filter = (AynThorScaler::Filter)(mode - SCALE_MODE_INTEGER);
+        return true;
+    }
+    // Layers and copy rotations need the render pass; the blit is replaced
+    // by a plain bilinear draw.
+    r_filter = AynThorScaler::FILTER_BILINEAR;
+    return p_frame.layer_count > 0 || copy_rotation_degrees.load(std::memory_order_relaxed) != 0;
+}
+
+void AynThorRenderer::_record_copy(VkCommandBuffer p_command_buffer, const SourceFrame& p_frame, uint32_t p_image_index) {
+    // The scaler rewrites the source's descriptor set for a new view, which
+    // the cached copies of the old one still point at.
+    std::vector<CachedCopy> &copies = frames[ring.get_current_index()].copies;
+    for (size_t i = p_frame.slot; i < copies.size(); i += SOURCE_SLOTS) {
+        if (copies[i].valid && copies[i].key.view != p_frame.view) copies[i].valid = false;
+    }
+    vkResetCommandBuffer(p_command_buffer, 0);
 
-    vkResetFences(vk_device, 1, &in_flight_fence);
-    vkResetCommandBuffer(command_buffer, 0);
-    
     VkCommandBufferBeginInfo beginInfo = {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    vkBeginCommandBuffer(command_buffer, &beginInfo);
+    vkBeginCommandBuffer(p_command_buffer, &beginInfo);
 
-    VkImageMemoryBarrier barrier_dst = {};
-    barrier_dst.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier_dst.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    barrier_dst.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier_dst.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier_dst.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier_dst.image = swapchain_images[imageIndex];
-    barrier_dst.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier_dst.subresourceRange.levelCount = 1;
-    barrier_dst.subresourceRange.layerCount = 1;
-    barrier_dst.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-    VkImageMemoryBarrier barrier_src = {};
-    barrier_src.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier_src.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    barrier_src.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    barrier_src.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier_src.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier_src.image = source_image;
-    barrier_src.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier_src.subresourceRange.levelCount = 1;
-    barrier_src.subresourceRange.layerCount = 1;
-    barrier_src.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    barrier_src.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-    Ref<RDTextureFormat> texture_format = rd->texture_get_format(rd_texture_rid);
-    if (texture_format.is_null()) return;
-
-    int32_t src_w = (int32_t)texture_format->get_width();
-    int32_t src_h = (int32_t)texture_format->get_height();
-    if (src_w <= 0 || src_h <= 0) return;
-
-    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier_dst);
-    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier_src);
-
-    VkImageBlit blit = {};
-    blit.srcOffsets[0] = {src_w, src_h, 0};
-    blit.srcOffsets[1] = {0, 0, 1};
-    blit.dstOffsets[0] = {0, 0, 0};
-    blit.dstOffsets[1] = {(int32_t)width, (int32_t)height, 1};
-    blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    blit.srcSubresource.layerCount = 1;
-    blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    blit.dstSubresource.layerCount = 1;
-
-    vkCmdBlitImage(command_buffer, source_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, swapchain_images[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
-
-    VkImageMemoryBarrier barrier_present = {};
-    barrier_present.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier_present.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier_present.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-    barrier_present.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier_present.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier_present.image = swapchain_images[imageIndex];
-    barrier_present.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier_present.subresourceRange.levelCount = 1;
-    barrier_present.subresourceRange.layerCount = 1;
-    barrier_present.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-    VkImageMemoryBarrier barrier_restore = {};
-    barrier_restore.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier_restore.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    barrier_restore.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    barrier_restore.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier_restore.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier_restore.image = source_image;
-    barrier_restore.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier_restore.subresourceRange.levelCount = 1;
-    barrier_restore.subresourceRange.layerCount = 1;
-    barrier_restore.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-    barrier_restore.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier_present);
-    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier_restore);
+    ring.write_start_timestamp(p_command_buffer);
 
-    vkEndCommandBuffer(command_buffer);
+    AynThorScaler::Filter filter;
+    if (_scaler_filter(p_frame, filter)) {
+        scaler.record(p_command_buffer, ring.get_current_index() * SOURCE_SLOTS + p_frame.slot, p_image_index, p_frame.image, p_frame.view, p_frame.state, p_frame.width, p_frame.height, filter, sharpness.load(std::memory_order_relaxed), p_frame.layers, p_frame.layer_count);
+    } else {
+        AynThorBlit::record(p_command_buffer, p_frame.image, p_frame.state, p_frame.width, p_frame.height, swapchain_images[p_image_index], (int32_t)width, (int32_t)height);
+    }
+
+    ring.write_end_timestamp(p_command_buffer);
+}
+
+VkCommandBuffer AynThorRenderer::_cached_copy(const SourceFrame& p_frame, uint32_t p_image_index) {
+    FrameContext &frame = frames[ring.get_current_index()];
+    // Emptied whenever the swapchain is rebuilt.
+    if (frame.copies.empty()) frame.copies.resize(swapchain_images.size() * SOURCE_SLOTS);
+
+    CopyKey key;
+    key.source = p_frame.image;
+    key.view = p_frame.view;
+    key.layout = p_frame.state.layout;
+    key.width = p_frame.width;
+    key.height = p_frame.height;
+    key.mode = scaler.is_ready() && p_frame.view ? scale_mode.load(std::memory_order_relaxed) : SCALE_MODE_BLIT;
+    key.sharpness = key.mode == SCALE_MODE_BLIT ? 0.0f : sharpness.load(std::memory_order_relaxed);
+    key.layers_version = p_frame.layers_version;
+
+    CachedCopy &copy = frame.copies[p_image_index * SOURCE_SLOTS + p_frame.slot];
+    if (copy.valid && copy.key == key) return copy.command_buffer;
+
+    if (!copy.command_buffer) {
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = command_pool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(vk_device, &allocInfo, &copy.command_buffer) != VK_SUCCESS) {
+            // Still works, just recorded every frame.
+            copy.command_buffer = VK_NULL_HANDLE;
+            VkCommandBuffer command_buffer = ring.get_current().command_buffer;
+            _record_copy(command_buffer, p_frame, p_image_index);
+            vkEndCommandBuffer(command_buffer);
+            return command_buffer;
+        }
+    }
 
-    VkSemaphore waitSemaphores[] = {image_available_semaphore};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    VkSemaphore signalSemaphores[] = {render_finished_semaphore};
+    _record_copy(copy.command_buffer, p_frame, p_image_index);
+    vkEndCommandBuffer(copy.command_buffer);
+    copy.key = key;
+    copy.valid = true;
+    return copy.command_buffer;
+}
+
+void AynThorRenderer::_release_copy_cache() {
+    // Callers have waited for the ring, so none of these are pending.
+    for (FrameContext &frame : frames) {
+        for (CachedCopy &copy : frame.copies) {
+            if (copy.command_buffer && command_pool) vkFreeCommandBuffers(vk_device, command_pool, 1, &copy.command_buffer);
+        }
+        frame.copies.clear();
+    }
+}
+
+AynThorRenderer::PresentResult AynThorRenderer::_acquire_image(uint64_t p_timeout_ns, AynThorFrameStats::FrameTiming& r_timing, uint32_t& r_image_index) {
+    ring.wait_slot(r_timing);
+
+    // Fallback probe: any slot whose fence has signaled by now counts as shown.
+    uint64_t fence_checked_ns = _monotonic_ns();
+    for (uint32_t i = 0; i < (uint32_t)frames.size(); i++) {
+        FrameContext &other = frames[i];
+        if (!other.probe_present_id || vkGetFenceStatus(vk_device, ring.get_slot(i).in_flight_fence) != VK_SUCCESS) continue;
+        latency_probe.presented(other.probe_present_id, fence_checked_ns, AynThorLatencyProbe::SOURCE_FENCE);
+        other.probe_present_id = 0;
+    }
+    capture.retire(ring.get_current_index());
+    capture.poll();
+
+    switch (ring.acquire(swapchain, p_timeout_ns, r_timing, r_image_index)) {
+        case AynThorPresentRing::RESULT_OK: return PRESENT_OK;
+        case AynThorPresentRing::RESULT_TIMEOUT: return PRESENT_TIMEOUT;
+        case AynThorPresentRing::RESULT_SURFACE_LOST: return PRESENT_SURFACE_LOST;
+        case AynThorPresentRing::RESULT_OUT_OF_DATE: return PRESENT_OUT_OF_DATE;
+        default: return PRESENT_FAILED;
+    }
+}
+
+// Rebuilds a stale swapchain, then acquires. Runs on whichever thread owns
+// the swapchain: the present thread while it runs, else the main thread.
+AynThorRenderer::PresentResult AynThorRenderer::_acquire_next(uint64_t p_timeout_ns, AynThorFrameStats::FrameTiming& r_timing, uint32_t& r_image_index) {
+    uint64_t generation = active_display->surface_generation.load(std::memory_order_acquire);
+    if (generation != surface_generation) {
+        surface_generation = generation;
+        swapchain_dirty.store(true);
+    }
+    if (swapchain_dirty.exchange(false) || !swapchain) {
+        if (!_recreate_swapchain()) return PRESENT_SURFACE_LOST;
+    }
+
+    PresentResult result = _acquire_image(p_timeout_ns, r_timing, r_image_index);
+    if (result == PRESENT_OUT_OF_DATE) {
+        // Nothing was acquired, so the frame is simply retried on the new swapchain.
+        if (!_recreate_swapchain()) return PRESENT_SURFACE_LOST;
+        return PRESENT_TIMEOUT;
+    }
+    return result;
+}
+
+// The most precise way this device has to tell when a frame was shown.
+AynThorLatencyProbe::Source AynThorRenderer::_latency_source() const {
+    if (fp_get_past_presentation_timing) return AynThorLatencyProbe::SOURCE_DISPLAY_TIMING;
+    // Only the present thread waits for presents.
+    if (fp_wait_for_present && present_thread_running.load(std::memory_order_relaxed)) return AynThorLatencyProbe::SOURCE_PRESENT_WAIT;
+    return AynThorLatencyProbe::SOURCE_FENCE;
+}
+
+AynThorRenderer::PresentResult AynThorRenderer::_submit_and_present(VkCommandBuffer p_command_buffer, uint32_t p_image_index, VkSemaphore p_wait_semaphore, int p_capture_slot, bool p_timestamps, int64_t p_touch_ns, AynThorFrameStats::FrameTiming& r_timing) {
+    uint32_t slot_index = ring.get_current_index();
+    FrameContext &frame = frames[slot_index];
+    AynThorPresentRing::Slot &slot = ring.get_current();
+    uint64_t submit_start = _monotonic_ns();
+
+    // On Godot's queue the copy follows the source's render in submission
+    // order, so only the acquire is waited on.
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;
-    submitInfo.pWaitDstStageMask = waitStages;
+    submitInfo.waitSemaphoreCount = p_wait_semaphore ? 1 : 0;
+    submitInfo.pWaitSemaphores = &p_wait_semaphore;
+    submitInfo.pWaitDstStageMask = &waitStage;
     submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &command_buffer;
+    submitInfo.pCommandBuffers = &p_command_buffer;
     submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = signalSemaphores;
+    submitInfo.pSignalSemaphores = &slot.render_finished_semaphore;
 
-    if (vkQueueSubmit(vk_queue, 1, &submitInfo, in_flight_fence) != VK_SUCCESS) {
-        return;
+    std::lock_guard<std::mutex> queue_lock(*queue_mutex);
+
+    VkFence fence = ring.begin_submit();
+    if (vkQueueSubmit(vk_queue, 1, &submitInfo, fence) != VK_SUCCESS) {
+        if (p_capture_slot >= 0) capture.cancel(p_capture_slot);
+        return PRESENT_FAILED;
     }
+    if (p_capture_slot >= 0) capture.submitted(p_capture_slot, slot_index, fence);
+    ring.end_submit(p_timestamps, r_timing.start_ns);
 
     VkPresentInfoKHR presentInfo = {};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+    presentInfo.pWaitSemaphores = &slot.render_finished_semaphore;
     presentInfo.swapchainCount = 1;
     presentInfo.pSwapchains = &swapchain;
-    presentInfo.pImageIndices = &imageIndex;
+    presentInfo.pImageIndices = &p_image_index;
+
+    uint64_t present_id = next_present_id++;
+
+    VkPresentTimeGOOGLE present_time = {};
+    VkPresentTimesInfoGOOGLE present_times = {};
+    if (fp_get_past_presentation_timing) {
+        // Ask the compositor to hold the frame until its slot on the interval
+        // grid, so early submits do not shorten the previous frame.
+        present_time.presentID = (uint32_t)present_id;
+        present_time.desiredPresentTime = pacer.desired_present_time(_monotonic_ns());
+        present_times.sType = VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE;
+        present_times.swapchainCount = 1;
+        present_times.pTimes = &present_time;
+        present_times.pNext = presentInfo.pNext;
+        presentInfo.pNext = &present_times;
+    }
 
-    res = vkQueuePresentKHR(vk_queue, &presentInfo);
-    if (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_ERROR_SURFACE_LOST_KHR) {
-        _cleanup_vulkan();
+    VkPresentIdKHR present_id_info = {};
+    if (fp_wait_for_present) {
+        present_id_info.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+        present_id_info.swapchainCount = 1;
+        present_id_info.pPresentIds = &present_id;
+        present_id_info.pNext = presentInfo.pNext;
+        presentInfo.pNext = &present_id_info;
+    }
+
+    AynThorPresentRing::Result result = ring.present(vk_queue, presentInfo, submit_start, r_timing);
+    frame_stats.record(r_timing);
+    if (r_timing.usec[AynThorFrameStats::METRIC_GPU_COPY] >= 0.0) {
+        last_gpu_copy_usec.store(r_timing.usec[AynThorFrameStats::METRIC_GPU_COPY], std::memory_order_relaxed);
+    }
+
+    if (result == AynThorPresentRing::RESULT_SURFACE_LOST) {
+        return PRESENT_SURFACE_LOST;
+    } else if (result == AynThorPresentRing::RESULT_OUT_OF_DATE || result == AynThorPresentRing::RESULT_SUBOPTIMAL) {
+        // Rebuilt lazily before the next acquire.
+        swapchain_dirty.store(true);
+    }
+    if (result == AynThorPresentRing::RESULT_OK || result == AynThorPresentRing::RESULT_SUBOPTIMAL) {
+        last_present_id = present_id;
+        if (p_touch_ns) {
+            latency_probe.submitted(present_id, p_touch_ns);
+            if (_latency_source() == AynThorLatencyProbe::SOURCE_FENCE) frame.probe_present_id = present_id;
+        }
     }
+    _observe_presentation();
+    return PRESENT_OK;
+}
+#endif
+
+void AynThorRenderer::_start_present_thread() {
+#ifdef __ANDROID__
+    if (present_thread_running.load() || !initialized) return;
+    present_thread_lost.store(false);
+    present_thread_running.store(true);
+    present_thread = std::thread(&AynThorRenderer::_present_thread_loop, this);
 #endif
 }
 
-void AynThorRenderer::_cleanup_vulkan() {
+void AynThorRenderer::_stop_present_thread() {
+    if (!present_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(present_wake_mutex);
+        present_thread_running.store(false);
+    }
+    present_wake_cv.notify_all();
+    present_thread.join();
+}
+
+// Main thread. Whether the present thread has an image ready, waiting up to
+// p_timeout_usec for one.
+bool AynThorRenderer::_wait_acquired_image(uint64_t p_timeout_usec) {
 #ifdef __ANDROID__
-    if (initialized && vk_device) {
-        vkDeviceWaitIdle(vk_device);
-        if (image_available_semaphore) {
-            vkDestroySemaphore(vk_device, image_available_semaphore, nullptr);
-            image_available_semaphore = VK_NULL_HANDLE;
+    std::unique_lock<std::mutex> lock(present_wake_mutex);
+    present_wake_cv.wait_for(lock, std::chrono::microseconds(p_timeout_usec), [this]() { return image_acquired || !present_thread_running.load(); });
+    return image_acquired;
+#else
+    return false;
+#endif
+}
+
+// Main thread, once the image has been presented or given up on.
+void AynThorRenderer::_return_acquired_image() {
+#ifdef __ANDROID__
+    {
+        std::lock_guard<std::mutex> lock(present_wake_mutex);
+        image_acquired = false;
+    }
+    present_wake_cv.notify_all();
+#endif
+}
+
+void AynThorRenderer::_present_thread_loop() {
+#ifdef __ANDROID__
+    while (present_thread_running.load(std::memory_order_acquire)) {
+        uint64_t timeout_usec = _frame_interval_usec();
+        {
+            // The main thread owns the swapchain and the ring while it holds
+            // an image.
+            std::unique_lock<std::mutex> lock(present_wake_mutex);
+            present_wake_cv.wait(lock, [this]() { return !present_thread_running.load() || !image_acquired; });
+            if (!present_thread_running.load()) break;
+        }
+
+        // Without display timing, present wait keeps the thread one frame
+        // behind the panel and tells the pacer where vsync is.
+        if (!fp_get_past_presentation_timing && last_present_id != waited_present_id) {
+            waited_present_id = last_present_id;
+            _wait_for_display(timeout_usec * 2000);
+        }
+
+        // Bounded, so stopping the thread never waits on the compositor.
+        AynThorFrameStats::FrameTiming timing;
+        uint32_t image_index = 0;
+        PresentResult result = _acquire_next(timeout_usec * 1000, timing, image_index);
+        if (result == PRESENT_SURFACE_LOST) {
+            // Tear-down has to happen on the main thread, which owns init.
+            present_thread_lost.store(true, std::memory_order_release);
+            break;
         }
-        if (render_finished_semaphore) {
-            vkDestroySemaphore(vk_device, render_finished_semaphore, nullptr);
-            render_finished_semaphore = VK_NULL_HANDLE;
+        if (result == PRESENT_FAILED) {
+            std::unique_lock<std::mutex> lock(present_wake_mutex);
+            present_wake_cv.wait_for(lock, std::chrono::microseconds(timeout_usec), [this]() { return !present_thread_running.load(); });
         }
-        if (in_flight_fence) {
-            vkDestroyFence(vk_device, in_flight_fence, nullptr);
-            in_flight_fence = VK_NULL_HANDLE;
+        if (result != PRESENT_OK) continue;
+
+        {
+            std::lock_guard<std::mutex> lock(present_wake_mutex);
+            acquired_image_index = image_index;
+            acquired_timing = timing;
+            image_acquired = true;
         }
+        present_wake_cv.notify_all();
+    }
+#endif
+}
+
+void AynThorRenderer::_cleanup_vulkan() {
+    _stop_present_thread();
+#ifdef __ANDROID__
+    if (initialized && vk_device) {
+        _wait_own_work();
+        _save_pipeline_cache();
+        scaler.cleanup();
+        _destroy_frame_contexts();
+        capture.cleanup_gpu();
+        ring.destroy_timestamps();
+        _destroy_direct_textures();
+        ring.destroy_retired_swapchains();
         if (swapchain) {
             vkDestroySwapchainKHR(vk_device, swapchain, nullptr);
             swapchain = VK_NULL_HANDLE;
@@ -423,10 +2519,17 @@ void AynThorRenderer::_cleanup_vulkan() {
             vkDestroyCommandPool(vk_device, command_pool, nullptr);
             command_pool = VK_NULL_HANDLE;
         }
-        command_buffer = VK_NULL_HANDLE;
     }
+    last_present_id = 0;
+    swapchain_refresh_period_ns.store(0);
+    pacer.reset();
+    AynThorDisplayRegistry::release_window(last_window);
     last_window = nullptr;
+    active_display = nullptr;
+    active_display_id = -1;
 #endif
+    for (RID& rid : cached_source_rd_textures) rid = RID();
+    output_ready.store(false);
     initialized = false;
 }
 
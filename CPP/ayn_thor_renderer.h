@@ -4,8 +4,26 @@
 #include <godot_cpp/classes/node.hpp>
 #include <godot_cpp/classes/rendering_server.hpp>
 #include <godot_cpp/classes/rendering_device.hpp>
+#include <godot_cpp/classes/viewport.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#include "ayn_thor_blit.h"
+#include "ayn_thor_capture.h"
+#include "ayn_thor_direct_interface.h"
+#include "ayn_thor_display_registry.h"
+#include "ayn_thor_dynamic_resolution.h"
+#include "ayn_thor_frame_pacer.h"
+#include "ayn_thor_frame_stats.h"
+#include "ayn_thor_latency_probe.h"
+#include "ayn_thor_present_ring.h"
+#include "ayn_thor_scaler.h"
+#include "ayn_thor_touch_ring.h"
+#include "ayn_thor_viewport_scheduler.h"
+
 #ifdef __ANDROID__
 #define VK_USE_PLATFORM_ANDROID_KHR
 #include <vulkan/vulkan.h>
@@ -16,8 +34,113 @@ namespace godot {
 
 class AynThorRenderer : public Node {
     GDCLASS(AynThorRenderer, Node)
+    friend class AynThorDirectInterface;
+
+public:
+    enum FramePolicy {
+        FRAME_POLICY_DROP,
+        FRAME_POLICY_BLOCK,
+    };
+
+    enum ScaleMode {
+        SCALE_MODE_BLIT,
+        SCALE_MODE_INTEGER,
+        SCALE_MODE_SHARP_BILINEAR,
+        SCALE_MODE_EDGE_ADAPTIVE,
+    };
+
+    enum PresentModePolicy {
+        PRESENT_MODE_LOW_LATENCY, // MAILBOX, else FIFO
+        PRESENT_MODE_VSYNC, // FIFO
+        PRESENT_MODE_ADAPTIVE, // FIFO_RELAXED, else FIFO
+    };
+
+    enum SwapchainFormat {
+        SWAPCHAIN_FORMAT_RGBA8,
+        SWAPCHAIN_FORMAT_LOW_BANDWIDTH, // R5G6B5, else RGBA8
+        SWAPCHAIN_FORMAT_HIGH_PRECISION, // A2B10G10R10, else RGBA8
+    };
+
+    enum PacingSource {
+        PACING_ACCUMULATOR,
+        PACING_DISPLAY_TIMING,
+        PACING_PRESENT_WAIT,
+    };
+
+    enum TraceFormat {
+        TRACE_FORMAT_CSV,
+        TRACE_FORMAT_CHROME,
+    };
+
+    enum CaptureFileFormat {
+        CAPTURE_FILE_RAW,
+        CAPTURE_FILE_QOI,
+    };
+
+    // Mirrors AynThorViewportScheduler::Policy.
+    enum UpdatePolicy {
+        UPDATE_POLICY_ALWAYS,
+        UPDATE_POLICY_DIVISOR,
+        UPDATE_POLICY_STAGGERED,
+        UPDATE_POLICY_VSYNC,
+    };
+
+    // Mirrors AynThorLatencyProbe::Source.
+    enum LatencySource {
+        LATENCY_SOURCE_NONE,
+        LATENCY_SOURCE_DISPLAY_TIMING,
+        LATENCY_SOURCE_PRESENT_WAIT,
+        LATENCY_SOURCE_FENCE,
+    };
+
+    // Where the panel rotation of the current swapchain is done.
+    enum RotationPath {
+        ROTATION_PATH_PRE_TRANSFORM, // The surface's own transform is the rotation; free.
+        ROTATION_PATH_COPY, // The copy pass rotates; buffer in surface transform.
+        ROTATION_PATH_COMPOSITOR, // Pre-transform differs from the surface's; the compositor rotates.
+        ROTATION_PATH_NONE, // Neither the copy nor a pre-transform can rotate; shown unrotated.
+    };
+
+    // Returned by schedule_viewports().
+    enum ScheduleFlags {
+        SCHEDULE_SECOND_RENDERING = 1, // Renders at the end of this frame.
+        SCHEDULE_SECOND_READY = 2, // Finished last frame; present it now.
+    };
 
 private:
+    // Everything the present path needs to know about a source texture,
+    // resolved on the main thread right before it is copied.
+    struct SourceFrame {
+#ifdef __ANDROID__
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        AynThorImageState state;
+#endif
+        // Entry of the source cache it was resolved through, which picks its
+        // cached copies and scaler descriptor set.
+        uint32_t slot = 0;
+        int32_t width = 0;
+        int32_t height = 0;
+        // Of the source's format, for get_stats().
+        uint32_t bytes_per_pixel = 4;
+#ifdef __ANDROID__
+        // Resolved layers in draw order, skipping ones without a texture.
+        AynThorScaler::Layer layers[AynThorScaler::MAX_LAYERS];
+        uint32_t layer_count = 0;
+#endif
+        // Bumped whenever the layers or their textures change.
+        uint64_t layers_version = 0;
+    };
+
+    enum PresentResult {
+        PRESENT_OK,
+        PRESENT_TIMEOUT,
+        PRESENT_FAILED,
+        PRESENT_SURFACE_LOST,
+        // Only returned by _acquire_image; the caller decides when to rebuild.
+        PRESENT_OUT_OF_DATE,
+    };
+
 #ifdef __ANDROID__
     VkInstance vk_instance = VK_NULL_HANDLE;
     VkPhysicalDevice vk_physical_device = VK_NULL_HANDLE;
@@ -29,48 +152,490 @@ private:
     VkSwapchainKHR swapchain = VK_NULL_HANDLE;
     std::vector<VkImage> swapchain_images;
     VkCommandPool command_pool = VK_NULL_HANDLE;
-    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
 
-    VkSemaphore image_available_semaphore = VK_NULL_HANDLE;
-    VkSemaphore render_finished_semaphore = VK_NULL_HANDLE;
-    VkFence in_flight_fence = VK_NULL_HANDLE;
+    // Everything a recorded copy depends on besides the ring slot and the
+    // swapchain image it was recorded for.
+    struct CopyKey {
+        VkImage source = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        int32_t width = 0;
+        int32_t height = 0;
+        ScaleMode mode = SCALE_MODE_BLIT;
+        float sharpness = 0.0f;
+        uint64_t layers_version = 0;
+
+        bool operator==(const CopyKey& p_other) const {
+            return source == p_other.source && view == p_other.view && layout == p_other.layout && width == p_other.width &&
+                    height == p_other.height && mode == p_other.mode && sharpness == p_other.sharpness && layers_version == p_other.layers_version;
+        }
+    };
+    struct CachedCopy {
+        VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+        CopyKey key;
+        bool valid = false;
+    };
+
+    // The present ring, shared with the headless benchmark. The CPU only
+    // blocks on a slot's fence when the ring wraps around onto a frame the
+    // GPU has not finished yet.
+    AynThorPresentRing ring;
+    // What the renderer keeps per ring slot on top, at the same index.
+    struct FrameContext {
+        // Direct mode: moves the acquired image to COLOR_ATTACHMENT_OPTIMAL
+        // ahead of Godot's frame.
+        VkCommandBuffer acquire_command_buffer = VK_NULL_HANDLE;
+        // Signaled by that submit, for a tear-down that comes before the
+        // frame's present.
+        VkFence acquire_fence = VK_NULL_HANDLE;
+        // Copies recorded once per swapchain image and resubmitted while
+        // their key matches. Only this slot submits them, so waiting on its
+        // fence is enough before reusing one.
+        std::vector<CachedCopy> copies;
+        // Present id of the slot's frame while the latency probe waits on
+        // its fence, else 0.
+        uint64_t probe_present_id = 0;
+    };
+    std::vector<FrameContext> frames;
 
     VkFormat swapchain_image_format = VK_FORMAT_R8G8B8A8_UNORM;
+
+    AynThorScaler scaler;
+
+    // Optional pacing extensions; null when Godot did not enable them.
+    PFN_vkGetRefreshCycleDurationGOOGLE fp_get_refresh_cycle_duration = nullptr;
+    PFN_vkGetPastPresentationTimingGOOGLE fp_get_past_presentation_timing = nullptr;
+    PFN_vkWaitForPresentKHR fp_wait_for_present = nullptr;
+    uint64_t next_present_id = 1;
+    uint64_t last_present_id = 0;
+
+    // The swapchain images can be read back; requested while capturing.
+    bool swapchain_capture_usage = false;
+
+    // Swapchain images wrapped as RenderingDevice textures in direct mode,
+    // and the image acquired for the frame Godot is drawing.
+    std::vector<RID> direct_textures;
+    uint32_t direct_image_index = 0;
+    bool direct_acquired = false;
+    uint64_t direct_acquire_end_ns = 0;
+    AynThorFrameStats::FrameTiming direct_timing;
+    int64_t direct_touch_ns = 0;
+
+    // Image the present thread acquired for the main thread to record,
+    // submit and present; guarded by present_wake_mutex while the thread
+    // runs. Only the side that does not hold it touches the swapchain and
+    // the ring.
+    bool image_acquired = false;
+    uint32_t acquired_image_index = 0;
+    AynThorFrameStats::FrameTiming acquired_timing;
+    // Last present the present thread waited to reach the panel.
+    uint64_t waited_present_id = 0;
 #endif
 
-    uint32_t width = 0;
-    uint32_t height = 0;
+    // Written by whichever thread builds the swapchain.
+    std::atomic<uint32_t> width{0};
+    std::atomic<uint32_t> height{0};
 
     bool initialized = false;
+    // Display this renderer drives; -1 follows the first available one.
+    std::atomic<int> display_id{-1};
+    // Set while initialized: the display the surface belongs to and our own
+    // reference on its window.
+    AynThorDisplayRegistry::Display* active_display = nullptr;
+    int32_t active_display_id = -1;
+    uint64_t window_generation = 0;
     void* last_window = nullptr;
     
-    int target_fps = 0;
-    uint64_t last_frame_time_usec = 0;
-    int rotation_degrees = 180;
+    std::atomic<int> target_fps{0};
+    std::atomic<int> refresh_divisor{0};
+    std::atomic<PresentModePolicy> present_mode_policy{PRESENT_MODE_LOW_LATENCY};
+    std::atomic<SwapchainFormat> swapchain_format{SWAPCHAIN_FORMAT_RGBA8};
+    // 0 picks one more than the surface minimum.
+    std::atomic<int> swapchain_image_count{0};
+    // What the last swapchain ended up with, for get_stats().
+    std::atomic<int> swapchain_vk_format{0};
+    std::atomic<uint32_t> swapchain_images_created{0};
+    std::atomic<uint64_t> swapchain_image_bytes{0};
+    AynThorFramePacer pacer;
+    std::atomic<bool> pacing_dirty{true};
+    // Refresh period reported by VK_GOOGLE_display_timing, 0 when unknown.
+    std::atomic<uint64_t> swapchain_refresh_period_ns{0};
+    std::atomic<int> rotation_degrees{180};
+    // Rotate with a pre-transform that differs from the surface's, leaving
+    // the turn to the compositor, instead of in the copy.
+    std::atomic<bool> compositor_rotation{false};
+    std::atomic<bool> swapchain_dirty{false};
+    uint64_t surface_generation = 0;
+    int frames_in_flight = 2;
+
+    bool threaded_present = false;
+    std::atomic<FramePolicy> frame_policy{FRAME_POLICY_DROP};
+    std::thread present_thread;
+    // The plugin's own submits and presents, shared by every renderer on
+    // the same queue; Godot's queue use is not covered.
+    std::mutex* queue_mutex = nullptr;
+    std::atomic<bool> present_thread_running{false};
+    std::atomic<bool> present_thread_lost{false};
+    std::mutex present_wake_mutex;
+    std::condition_variable present_wake_cv;
+    std::atomic<uint64_t> dropped_frames{0};
+    std::atomic<uint64_t> late_frames{0};
+    std::atomic<uint64_t> swapchain_recreations{0};
+
+    // Builds the surface and swapchain off the main thread as soon as a
+    // window appears. It holds output_mutex while doing so; the main thread
+    // only try-locks it and skips the frame instead of waiting.
+    struct SetupListener : AynThorDisplayRegistry::Listener {
+        AynThorRenderer* renderer = nullptr;
+        void window_changed(int32_t p_display_id) override;
+    };
+    SetupListener setup_listener;
+    std::thread setup_thread;
+    std::mutex setup_wake_mutex;
+    std::condition_variable setup_wake_cv;
+    // Guarded by setup_wake_mutex.
+    bool setup_thread_running = false;
+    bool setup_requested = false;
+    // Guards the Vulkan state against the setup thread.
+    std::mutex output_mutex;
+    std::atomic<bool> output_ready{false};
+    // Queried once on the main thread, since they go through the
+    // RenderingDevice; the setup thread only makes Vulkan calls.
+    bool device_prepared = false;
+    std::vector<std::vector<uint32_t>> scaler_spirv;
+    std::vector<uint8_t> scaler_cache_data;
+
+    AynThorFrameStats frame_stats;
+    bool performance_monitors = false;
+    bool monitors_registered = false;
+    String monitor_category;
+
+    AynThorCapture capture;
+    int capture_fps = 0;
+    float capture_scale = 1.0f;
+
+    // Viewport scheduling, main thread only.
+    AynThorViewportScheduler viewport_scheduler;
+    UpdatePolicy update_policy = UPDATE_POLICY_ALWAYS;
+    int main_update_divisor = 1;
+    int second_update_divisor = 1;
+    bool second_render_pending = false;
+    // Engine frames at whose end the second viewport last rendered.
+    uint64_t second_render_frame = 0;
+    uint64_t previous_second_render_frame = 0;
+    uint64_t last_schedule_ns = 0;
+    uint64_t engine_frame_ns = 0;
+    RID staggered_viewports[2];
+
+    // Dynamic resolution, main thread only apart from the copy time.
+    AynThorDynamicResolution resolution_controller;
+    bool dynamic_resolution = false;
+    float dynamic_resolution_min_scale = 0.5f;
+    float dynamic_resolution_max_scale = 1.0f;
+    float gpu_budget_ms = 4.0f;
+    RID measured_viewport;
+    std::atomic<double> last_gpu_copy_usec{-1.0};
+
+    // Direct mode, see draw_viewport_direct(). Everything here is touched
+    // on the main thread only.
+    bool direct_mode = false;
+    // Set when this device or project cannot use it; cleared by set_direct_mode.
+    bool direct_unavailable = false;
+    // Which path the caller drives; the swapchain is rebuilt when it changes.
+    // Written on the main thread, read by the setup thread.
+    std::atomic<bool> direct_frames{false};
+    std::atomic<bool> direct_swapchain{false};
+    Ref<AynThorDirectInterface> direct_interface;
+    uint64_t direct_viewport_id = 0;
+    Vector2i direct_viewport_size;
+    Transform3D direct_camera_transform;
+    Projection direct_camera_projection;
+
+    std::atomic<ScaleMode> scale_mode{SCALE_MODE_BLIT};
+    std::atomic<float> sharpness{0.5f};
 
+    // Dirty tracking; the damage is only touched on the main thread.
+    bool dirty_tracking = false;
+    bool damage_pending = false;
+    bool damage_full = false;
+    Rect2i damage_rect;
+    uint64_t last_source_image = 0;
+    int32_t last_source_width = 0;
+    int32_t last_source_height = 0;
+    uint64_t presented_surface_generation = 0;
+    // Set when something other than the source changes what is on screen.
+    std::atomic<bool> content_invalidated{true};
+    std::atomic<uint64_t> skipped_frames{0};
+
+    bool latency_probe_enabled = false;
+    AynThorLatencyProbe latency_probe;
+
+    // Last resolved sources, main thread only. A resized viewport gets a new
+    // RD texture, so the RD RID alone tells when the lookups are stale. Two
+    // entries, so swapping screens alternates between cached sources.
+    static const uint32_t SOURCE_SLOTS = 2;
+    RID cached_source_rd_textures[SOURCE_SLOTS];
+    SourceFrame cached_sources[SOURCE_SLOTS];
+    uint32_t last_source_slot = 0;
+
+    // Layers composited over the source, main thread only. Kept sorted by z
+    // and re-resolved only when a texture's RD RID changes.
+    struct LayerEntry {
+        int32_t id = 0;
+        RID texture;
+        Rect2i source_rect;
+        Rect2i dest_rect;
+        float opacity = 1.0f;
+        int32_t z = 0;
+        // Cleared by set_layer; resolution is retried while it has no texture.
+        bool stale = true;
+        bool resolved = false;
+        RID rd_texture;
+#ifdef __ANDROID__
+        AynThorScaler::Layer frame;
+#endif
+    };
+    std::vector<LayerEntry> layers;
+    uint64_t layers_version = 1;
+    uint64_t last_layers_version = 0;
+
+    // Pre-transform the current swapchain was created with, in degrees, and
+    // the rest of rotation_degrees the copy pass applies on top of it.
+    std::atomic<int> present_transform_degrees{0};
+    std::atomic<int> copy_rotation_degrees{0};
+    std::atomic<RotationPath> rotation_path{ROTATION_PATH_PRE_TRANSFORM};
+    // The scaler could not be set up, so the copy cannot rotate and the
+    // pre-transform has to.
+    bool copy_rotation_unavailable = false;
+
+    static const int MAX_TOUCH_POINTERS = 32;
+    // Per-pointer state for flush_touch_input; drags are coalesced until
+    // the next touch event or the end of the flush.
+    struct TouchPointer {
+        bool down = false;
+        Vector2 position;
+        Vector2 screen_position;
+        int64_t time_ns = 0;
+        bool drag_pending = false;
+        Vector2 drag_relative;
+        Vector2 drag_screen_relative;
+        int64_t drag_start_ns = 0;
+    };
+    TouchPointer touch_pointers[MAX_TOUCH_POINTERS];
+    // Display whose touch ring this renderer owns, main thread only.
+    AynThorDisplayRegistry::Display* touch_display = nullptr;
+    bool touch_owner_warned = false;
+    void _release_touch_ring();
+
+    int32_t _resolve_display_id() const;
+    bool _prepare_device();
     void _init_vulkan();
     void _cleanup_vulkan();
-    void _create_swapchain();
+#ifdef __ANDROID__
+    void _create_swapchain(VkSwapchainKHR p_old_swapchain);
+#endif
+    bool _recreate_swapchain();
+    void _wait_own_work();
+    bool _create_frame_contexts();
+    void _destroy_frame_contexts();
+
+    bool _init_scaler();
+    void _save_pipeline_cache();
+
+    bool _prepare_output(bool p_async);
+    void _request_setup();
+    void _start_setup_thread();
+    void _stop_setup_thread();
+    void _setup_thread_loop();
+    bool _resolve_source(RID p_texture_rid, SourceFrame& r_frame);
+    void _resolve_layers(SourceFrame& r_frame);
+#ifdef __ANDROID__
+    bool _describe_texture(RID p_rd_texture_rid, VkImage& r_image, VkImageView& r_view, AynThorImageState& r_state, int32_t& r_width, int32_t& r_height);
+    bool _scaler_filter(const SourceFrame& p_frame, AynThorScaler::Filter& r_filter) const;
+#endif
+    PresentResult _present_source(const SourceFrame& p_frame, uint64_t p_timeout_ns);
+#ifdef __ANDROID__
+    void _record_copy(VkCommandBuffer p_command_buffer, const SourceFrame& p_frame, uint32_t p_image_index);
+    VkCommandBuffer _cached_copy(const SourceFrame& p_frame, uint32_t p_image_index);
+    void _release_copy_cache();
+    PresentResult _acquire_image(uint64_t p_timeout_ns, AynThorFrameStats::FrameTiming& r_timing, uint32_t& r_image_index);
+    PresentResult _acquire_next(uint64_t p_timeout_ns, AynThorFrameStats::FrameTiming& r_timing, uint32_t& r_image_index);
+    PresentResult _submit_and_present(VkCommandBuffer p_command_buffer, uint32_t p_image_index, VkSemaphore p_wait_semaphore, int p_capture_slot, bool p_timestamps, int64_t p_touch_ns, AynThorFrameStats::FrameTiming& r_timing);
+    AynThorLatencyProbe::Source _latency_source() const;
+#endif
+#ifdef __ANDROID__
+#endif
+    bool _take_damage(SourceFrame& r_frame);
+    uint64_t _second_rendered_frame() const;
+    void _flush_drags(Viewport* p_viewport);
+    uint64_t _frame_interval_usec() const;
+    void _update_pacing();
+    void _observe_presentation();
+    bool _wait_for_display(uint64_t p_timeout_ns);
+
+    bool _create_direct_textures();
+    void _destroy_direct_textures();
+    bool _register_direct_interface();
+    void _unregister_direct_interface();
+    void _set_direct_frames(bool p_direct);
+    void _release_direct_viewport();
+    // Called by AynThorDirectInterface from inside Godot's frame.
+    Vector2 _direct_target_size() const;
+    bool _direct_acquire();
+    RID _direct_texture() const;
+    void _direct_present();
+
+    void _register_monitors();
+    void _unregister_monitors();
+    double _get_monitor_value(int p_index);
+
+    void _start_present_thread();
+    void _stop_present_thread();
+    void _present_thread_loop();
+    bool _wait_acquired_image(uint64_t p_timeout_usec);
+    void _return_acquired_image();
 
 protected:
     static void _bind_methods();
+    void _notification(int p_what);
 
 public:
     AynThorRenderer();
     ~AynThorRenderer();
 
     bool is_window_available();
+    bool is_output_ready() const;
     void fill_color(float r, float g, float b);
     void draw_viewport_texture(RID texture_rid);
+    bool draw_viewport_direct(Viewport* p_viewport);
     Vector2i get_second_screen_size();
+    void flush_touch_input(Viewport* p_viewport);
+
+    static constexpr int MAX_FRAMES_IN_FLIGHT = (int)AynThorPresentRing::MAX_SLOTS;
+
+    void set_display_id(int p_display_id);
+    int get_display_id() const;
 
     void set_target_fps(int p_fps);
     int get_target_fps() const;
 
+    void set_refresh_divisor(int p_divisor);
+    int get_refresh_divisor() const;
+
+    void set_present_mode_policy(PresentModePolicy p_policy);
+    PresentModePolicy get_present_mode_policy() const;
+
+    void set_swapchain_format(SwapchainFormat p_format);
+    SwapchainFormat get_swapchain_format() const;
+
+    void set_swapchain_image_count(int p_count);
+    int get_swapchain_image_count() const;
+
+    float get_refresh_rate() const;
+    PacingSource get_pacing_source() const;
+
+    void set_frames_in_flight(int p_frames);
+    int get_frames_in_flight() const;
+
     void set_rotation_degrees(int p_degrees);
     int get_rotation_degrees() const;
+    RotationPath get_rotation_path() const;
+
+    void set_compositor_rotation(bool p_enabled);
+    bool is_compositor_rotation() const;
+
+    void set_threaded_present(bool p_enabled);
+    bool is_threaded_present() const;
+
+    void set_frame_policy(FramePolicy p_policy);
+    FramePolicy get_frame_policy() const;
+
+    void set_scale_mode(ScaleMode p_mode);
+    ScaleMode get_scale_mode() const;
+
+    void set_sharpness(float p_sharpness);
+    float get_sharpness() const;
+
+    void set_dirty_tracking(bool p_enabled);
+    bool is_dirty_tracking() const;
+    void mark_dirty(const Rect2i& p_rect = Rect2i());
+
+    void set_layer(int p_id, RID p_texture, const Rect2i& p_source_rect, const Rect2i& p_dest_rect, float p_opacity = 1.0f, int p_z = 0);
+    void remove_layer(int p_id);
+    void clear_layers();
+    int get_layer_count() const;
+
+    void set_latency_probe(bool p_enabled);
+    bool is_latency_probe() const;
+
+    int64_t get_dropped_frames() const;
+    int64_t get_skipped_frames() const;
+    int64_t get_late_frames() const;
+    void reset_frame_counters();
+
+    int64_t get_swapchain_recreations() const;
+    Dictionary get_stats();
+
+    void set_performance_monitors(bool p_enabled);
+    bool is_performance_monitors() const;
+
+    bool start_stats_trace(const String& p_path, TraceFormat p_format = TRACE_FORMAT_CSV);
+    void stop_stats_trace();
+
+    void set_direct_mode(bool p_enabled);
+    bool is_direct_mode() const;
+    bool is_direct_active() const;
+
+    void set_update_policy(UpdatePolicy p_policy);
+    UpdatePolicy get_update_policy() const;
+
+    void set_main_update_divisor(int p_divisor);
+    int get_main_update_divisor() const;
+
+    void set_second_update_divisor(int p_divisor);
+    int get_second_update_divisor() const;
+
+    BitField<ScheduleFlags> schedule_viewports(Viewport* p_main, Viewport* p_second, bool p_second_wanted = true);
+
+    void set_dynamic_resolution(bool p_enabled);
+    bool is_dynamic_resolution() const;
+
+    void set_dynamic_resolution_min_scale(float p_scale);
+    float get_dynamic_resolution_min_scale() const;
+
+    void set_dynamic_resolution_max_scale(float p_scale);
+    float get_dynamic_resolution_max_scale() const;
+
+    void set_gpu_budget_ms(float p_budget_ms);
+    float get_gpu_budget_ms() const;
+
+    float update_dynamic_resolution(RID p_viewport_rid);
+    float get_resolution_scale() const;
+
+    void set_capture_fps(int p_fps);
+    int get_capture_fps() const;
+
+    void set_capture_scale(float p_scale);
+    float get_capture_scale() const;
+
+    bool start_capture(const String& p_shared_path = String(), const String& p_file_path = String(), CaptureFileFormat p_file_format = CAPTURE_FILE_RAW);
+    void stop_capture();
+    bool is_capturing() const;
+    int get_capture_fd() const;
 };
 
 }
 
+VARIANT_ENUM_CAST(AynThorRenderer::FramePolicy);
+VARIANT_ENUM_CAST(AynThorRenderer::ScaleMode);
+VARIANT_ENUM_CAST(AynThorRenderer::PresentModePolicy);
+VARIANT_ENUM_CAST(AynThorRenderer::SwapchainFormat);
+VARIANT_ENUM_CAST(AynThorRenderer::PacingSource);
+VARIANT_ENUM_CAST(AynThorRenderer::TraceFormat);
+VARIANT_ENUM_CAST(AynThorRenderer::CaptureFileFormat);
+VARIANT_ENUM_CAST(AynThorRenderer::UpdatePolicy);
+VARIANT_BITFIELD_CAST(AynThorRenderer::ScheduleFlags);
+VARIANT_ENUM_CAST(AynThorRenderer::RotationPath);
+VARIANT_ENUM_CAST(AynThorRenderer::LatencySource);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,713 @@
+#include "ayn_thor_scaler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace godot {
+
+static const char* SCALER_VERTEX_SOURCE = R"(#version 450
+layout(push_constant, std430) uniform Params {
+    vec2 src_size;
+    vec2 src_texel;
+    vec2 uv_origin;
+    vec2 uv_axis_x;
+    vec2 uv_axis_y;
+    vec2 prescale;
+    float sharpness;
+    float opacity;
+} params;
+
+layout(location = 0) out vec2 uv;
+
+void main() {
+    vec2 pos = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    uv = params.uv_origin + pos.x * params.uv_axis_x + pos.y * params.uv_axis_y;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+static const char* SCALER_FRAGMENT_HEADER = R"(#version 450
+layout(push_constant, std430) uniform Params {
+    vec2 src_size;
+    vec2 src_texel;
+    vec2 uv_origin;
+    vec2 uv_axis_x;
+    vec2 uv_axis_y;
+    vec2 prescale;
+    float sharpness;
+    float opacity;
+} params;
+
+layout(set = 0, binding = 0) uniform sampler2D source;
+
+layout(location = 0) in vec2 uv;
+layout(location = 0) out vec4 frag_color;
+)";
+
+// Nearest texel; the destination rect is an integer multiple of the source.
+static const char* SCALER_INTEGER_SOURCE = R"(
+void main() {
+    ivec2 texel = clamp(ivec2(uv * params.src_size), ivec2(0), ivec2(params.src_size) - 1);
+    frag_color = vec4(texelFetch(source, texel, 0).rgb, 1.0);
+}
+)";
+
+// Nearest-neighbour prescale to the largest integer factor, then bilinear
+// for the remaining fraction, done analytically in one tap.
+static const char* SCALER_SHARP_BILINEAR_SOURCE = R"(
+void main() {
+    vec2 texel = uv * params.src_size;
+    vec2 texel_floored = floor(texel);
+    vec2 center_dist = fract(texel) - 0.5;
+    vec2 region_range = 0.5 - 0.5 / params.prescale;
+    vec2 f = (center_dist - clamp(center_dist, -region_range, region_range)) * params.prescale + 0.5;
+    frag_color = vec4(texture(source, (texel_floored + f) * params.src_texel).rgb, 1.0);
+}
+)";
+
+// Edge-directed upscale followed by a contrast-limited sharpen, in the
+// spirit of EASU + RCAS but collapsed into a single cheap pass.
+static const char* SCALER_EDGE_ADAPTIVE_SOURCE = R"(
+float luma(vec3 c) {
+    return dot(c, vec3(0.299, 0.587, 0.114));
+}
+
+void main() {
+    vec2 t = params.src_texel;
+    vec3 c = texture(source, uv).rgb;
+    vec3 n = texture(source, uv + vec2(0.0, -t.y)).rgb;
+    vec3 s = texture(source, uv + vec2(0.0, t.y)).rgb;
+    vec3 e = texture(source, uv + vec2(t.x, 0.0)).rgb;
+    vec3 w = texture(source, uv + vec2(-t.x, 0.0)).rgb;
+
+    vec2 grad = vec2(luma(e) - luma(w), luma(s) - luma(n));
+    float edge = length(grad);
+    vec3 color = c;
+    if (edge > 1e-4) {
+        vec2 along = vec2(-grad.y, grad.x) / edge * t * 0.5;
+        vec3 a = texture(source, uv + along).rgb;
+        vec3 b = texture(source, uv - along).rgb;
+        color = mix(c, (a + b) * 0.5, clamp(edge * 4.0, 0.0, 1.0));
+    }
+
+    vec3 lo = min(c, min(min(n, s), min(e, w)));
+    vec3 hi = max(c, max(max(n, s), max(e, w)));
+    vec3 detail = color * 4.0 - (n + s + e + w);
+    color = clamp(color + detail * (0.25 * params.sharpness), lo, hi);
+    frag_color = vec4(color, 1.0);
+}
+)";
+
+// Plain bilinear, for blit mode when layers force the render pass.
+static const char* SCALER_BILINEAR_SOURCE = R"(
+void main() {
+    frag_color = vec4(texture(source, uv).rgb, 1.0);
+}
+)";
+
+// Straight alpha, blended over what is already in the target.
+static const char* SCALER_LAYER_SOURCE = R"(
+void main() {
+    vec4 color = texture(source, uv);
+    frag_color = vec4(color.rgb, color.a * params.opacity);
+}
+)";
+
+std::string AynThorScaler::get_shader_source(ShaderStage p_stage) {
+    switch (p_stage) {
+        case STAGE_VERTEX: return SCALER_VERTEX_SOURCE;
+        case STAGE_FRAGMENT_INTEGER: return std::string(SCALER_FRAGMENT_HEADER) + SCALER_INTEGER_SOURCE;
+        case STAGE_FRAGMENT_SHARP_BILINEAR: return std::string(SCALER_FRAGMENT_HEADER) + SCALER_SHARP_BILINEAR_SOURCE;
+        case STAGE_FRAGMENT_EDGE_ADAPTIVE: return std::string(SCALER_FRAGMENT_HEADER) + SCALER_EDGE_ADAPTIVE_SOURCE;
+        case STAGE_FRAGMENT_BILINEAR: return std::string(SCALER_FRAGMENT_HEADER) + SCALER_BILINEAR_SOURCE;
+        case STAGE_FRAGMENT_LAYER: return std::string(SCALER_FRAGMENT_HEADER) + SCALER_LAYER_SOURCE;
+        default: return std::string();
+    }
+}
+
+void AynThorScaler::target_to_source(int p_rotation, float p_x, float p_y, float& r_u, float& r_v) {
+    switch (p_rotation) {
+        case 90: r_u = 1.0f - p_y; r_v = p_x; break;
+        case 180: r_u = p_x; r_v = p_y; break;
+        case 270: r_u = p_y; r_v = 1.0f - p_x; break;
+        default: r_u = 1.0f - p_x; r_v = 1.0f - p_y; break;
+    }
+}
+
+void AynThorScaler::source_to_target(int p_rotation, float p_u, float p_v, float& r_x, float& r_y) {
+    switch (p_rotation) {
+        case 90: r_x = p_v; r_y = 1.0f - p_u; break;
+        case 180: r_x = p_u; r_y = p_v; break;
+        case 270: r_x = 1.0f - p_v; r_y = p_u; break;
+        default: r_x = 1.0f - p_u; r_y = 1.0f - p_v; break;
+    }
+}
+
+#ifdef __ANDROID__
+
+// UV origin and per-axis steps across the drawn rect for a source sub-rect,
+// all normalized to the texture.
+static void _orient_params(int p_rotation, const float p_rect[4], float p_width, float p_height, AynThorScaler::Params& r_params) {
+    float u0, v0, ux, vx, uy, vy;
+    AynThorScaler::target_to_source(p_rotation, 0.0f, 0.0f, u0, v0);
+    AynThorScaler::target_to_source(p_rotation, 1.0f, 0.0f, ux, vx);
+    AynThorScaler::target_to_source(p_rotation, 0.0f, 1.0f, uy, vy);
+    float scale_u = p_rect[2] / p_width;
+    float scale_v = p_rect[3] / p_height;
+    r_params.uv_origin[0] = p_rect[0] / p_width + u0 * scale_u;
+    r_params.uv_origin[1] = p_rect[1] / p_height + v0 * scale_v;
+    r_params.uv_axis_x[0] = (ux - u0) * scale_u;
+    r_params.uv_axis_x[1] = (vx - v0) * scale_v;
+    r_params.uv_axis_y[0] = (uy - u0) * scale_u;
+    r_params.uv_axis_y[1] = (vy - v0) * scale_v;
+}
+
+bool AynThorScaler::init(VkDevice p_device, const std::vector<std::vector<uint32_t>>& p_spirv, const std::vector<uint8_t>& p_cache_data, uint32_t p_frame_slots) {
+    if (p_spirv.size() != STAGE_MAX) return false;
+    for (const std::vector<uint32_t>& code : p_spirv) {
+        if (code.empty()) return false;
+    }
+
+    device = p_device;
+    spirv = p_spirv;
+
+    VkPipelineCacheCreateInfo cacheInfo = {};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = p_cache_data.size();
+    cacheInfo.pInitialData = p_cache_data.empty() ? nullptr : p_cache_data.data();
+    if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipeline_cache) != VK_SUCCESS) {
+        // A stale or foreign blob is rejected by some drivers; start empty.
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipeline_cache) != VK_SUCCESS) {
+            cleanup();
+            return false;
+        }
+    }
+
+    VkSamplerCreateInfo samplerInfo = {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod = 0.0f;
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+        cleanup();
+        return false;
+    }
+
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    binding.pImmutableSamplers = &sampler;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptor_set_layout) != VK_SUCCESS) {
+        cleanup();
+        return false;
+    }
+
+    VkPushConstantRange pushRange = {};
+    pushRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(Params);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptor_set_layout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipeline_layout) != VK_SUCCESS) {
+        cleanup();
+        return false;
+    }
+
+    frame_slots = p_frame_slots;
+    uint32_t set_count = p_frame_slots * (1 + MAX_LAYERS);
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = set_count;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = set_count;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptor_pool) != VK_SUCCESS) {
+        cleanup();
+        return false;
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(set_count, descriptor_set_layout);
+    descriptor_sets.resize(set_count);
+    bound_views.assign(set_count, VK_NULL_HANDLE);
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptor_pool;
+    allocInfo.descriptorSetCount = set_count;
+    allocInfo.pSetLayouts = layouts.data();
+    if (vkAllocateDescriptorSets(device, &allocInfo, descriptor_sets.data()) != VK_SUCCESS) {
+        cleanup();
+        return false;
+    }
+
+    return true;
+}
+
+void AynThorScaler::cleanup() {
+    if (!device) return;
+    release_target();
+    _destroy_pipelines();
+    if (descriptor_pool) vkDestroyDescriptorPool(device, descriptor_pool, nullptr);
+    if (pipeline_layout) vkDestroyPipelineLayout(device, pipeline_layout, nullptr);
+    if (descriptor_set_layout) vkDestroyDescriptorSetLayout(device, descriptor_set_layout, nullptr);
+    if (sampler) vkDestroySampler(device, sampler, nullptr);
+    if (pipeline_cache) vkDestroyPipelineCache(device, pipeline_cache, nullptr);
+    descriptor_pool = VK_NULL_HANDLE;
+    pipeline_layout = VK_NULL_HANDLE;
+    descriptor_set_layout = VK_NULL_HANDLE;
+    sampler = VK_NULL_HANDLE;
+    pipeline_cache = VK_NULL_HANDLE;
+    descriptor_sets.clear();
+    bound_views.clear();
+    frame_slots = 0;
+    spirv.clear();
+    device = VK_NULL_HANDLE;
+}
+
+std::vector<uint8_t> AynThorScaler::get_cache_data() const {
+    std::vector<uint8_t> data;
+    if (!device || !pipeline_cache) return data;
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device, pipeline_cache, &size, nullptr) != VK_SUCCESS || size == 0) return data;
+    data.resize(size);
+    if (vkGetPipelineCacheData(device, pipeline_cache, &size, data.data()) != VK_SUCCESS) {
+        data.clear();
+    } else {
+        data.resize(size);
+    }
+    return data;
+}
+
+VkShaderModule AynThorScaler::_create_module(ShaderStage p_stage) {
+    VkShaderModuleCreateInfo moduleInfo = {};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = spirv[p_stage].size() * sizeof(uint32_t);
+    moduleInfo.pCode = spirv[p_stage].data();
+
+    VkShaderModule module = VK_NULL_HANDLE;
+    vkCreateShaderModule(device, &moduleInfo, nullptr, &module);
+    return module;
+}
+
+bool AynThorScaler::set_target(VkFormat p_format, const std::vector<VkImage>& p_images, VkExtent2D p_extent, int p_rotation) {
+    if (!device) return false;
+
+    // Pipelines only depend on the format; a resize keeps them.
+    if (render_pass && p_format != target_format) {
+        _destroy_pipelines();
+    }
+    release_target();
+
+    target_format = p_format;
+    target_extent = p_extent;
+    target_rotation = p_rotation;
+
+    if (!render_pass && !_create_pipelines()) {
+        return false;
+    }
+
+    for (VkImage image : p_images) {
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = target_format;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        VkImageView view = VK_NULL_HANDLE;
+        if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS) {
+            release_target();
+            return false;
+        }
+        target_views.push_back(view);
+
+        VkFramebufferCreateInfo framebufferInfo = {};
+        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferInfo.renderPass = render_pass;
+        framebufferInfo.attachmentCount = 1;
+        framebufferInfo.pAttachments = &view;
+        framebufferInfo.width = target_extent.width;
+        framebufferInfo.height = target_extent.height;
+        framebufferInfo.layers = 1;
+
+        VkFramebuffer framebuffer = VK_NULL_HANDLE;
+        if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS) {
+            release_target();
+            return false;
+        }
+        framebuffers.push_back(framebuffer);
+    }
+    return true;
+}
+
+void AynThorScaler::release_target() {
+    if (!device) return;
+    for (VkFramebuffer framebuffer : framebuffers) vkDestroyFramebuffer(device, framebuffer, nullptr);
+    for (VkImageView view : target_views) vkDestroyImageView(device, view, nullptr);
+    framebuffers.clear();
+    target_views.clear();
+}
+
+bool AynThorScaler::_create_pipelines() {
+    VkAttachmentDescription attachment = {};
+    attachment.format = target_format;
+    attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    VkAttachmentReference colorRef = {};
+    colorRef.attachment = 0;
+    colorRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &colorRef;
+
+    // Orders the layout transition after the acquire semaphore wait.
+    VkSubpassDependency dependency = {};
+    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependency.dstSubpass = 0;
+    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependency.srcAccessMask = 0;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    VkRenderPassCreateInfo renderPassInfo = {};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = 1;
+    renderPassInfo.pAttachments = &attachment;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+    renderPassInfo.dependencyCount = 1;
+    renderPassInfo.pDependencies = &dependency;
+    if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &render_pass) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkPipelineVertexInputStateCreateInfo vertexInput = {};
+    vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewportState = {};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer = {};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisample = {};
+    multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineColorBlendAttachmentState blendAttachment = {};
+    blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    VkPipelineColorBlendStateCreateInfo colorBlend = {};
+    colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlend.attachmentCount = 1;
+    colorBlend.pAttachments = &blendAttachment;
+
+    VkPipelineColorBlendAttachmentState layerBlendAttachment = blendAttachment;
+    layerBlendAttachment.blendEnable = VK_TRUE;
+    layerBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    layerBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    layerBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    layerBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    layerBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    layerBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo layerColorBlend = colorBlend;
+    layerColorBlend.pAttachments = &layerBlendAttachment;
+
+    VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicState = {};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    VkShaderModule vertexModule = _create_module(STAGE_VERTEX);
+    if (!vertexModule) {
+        _destroy_pipelines();
+        return false;
+    }
+
+    // All filters are built up front so switching modes never compiles;
+    // the last pass of the loop builds the blended layer pipeline.
+    bool ok = true;
+    for (int i = 0; i <= FILTER_MAX && ok; i++) {
+        VkShaderModule fragmentModule = _create_module((ShaderStage)(STAGE_FRAGMENT_INTEGER + i));
+        if (!fragmentModule) {
+            ok = false;
+            break;
+        }
+
+        VkPipelineShaderStageCreateInfo stages[2] = {};
+        stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        stages[0].module = vertexModule;
+        stages[0].pName = "main";
+        stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        stages[1].module = fragmentModule;
+        stages[1].pName = "main";
+
+        VkGraphicsPipelineCreateInfo pipelineInfo = {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.stageCount = 2;
+        pipelineInfo.pStages = stages;
+        pipelineInfo.pVertexInputState = &vertexInput;
+        pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pViewportState = &viewportState;
+        pipelineInfo.pRasterizationState = &rasterizer;
+        pipelineInfo.pMultisampleState = &multisample;
+        pipelineInfo.pColorBlendState = i < FILTER_MAX ? &colorBlend : &layerColorBlend;
+        pipelineInfo.pDynamicState = &dynamicState;
+        pipelineInfo.layout = pipeline_layout;
+        pipelineInfo.renderPass = render_pass;
+        pipelineInfo.subpass = 0;
+
+        VkPipeline &pipeline = i < FILTER_MAX ? pipelines[i] : layer_pipeline;
+        ok = vkCreateGraphicsPipelines(device, pipeline_cache, 1, &pipelineInfo, nullptr, &pipeline) == VK_SUCCESS;
+        vkDestroyShaderModule(device, fragmentModule, nullptr);
+    }
+    vkDestroyShaderModule(device, vertexModule, nullptr);
+
+    if (!ok) {
+        _destroy_pipelines();
+        return false;
+    }
+    return true;
+}
+
+void AynThorScaler::_destroy_pipelines() {
+    for (int i = 0; i < FILTER_MAX; i++) {
+        if (pipelines[i]) vkDestroyPipeline(device, pipelines[i], nullptr);
+        pipelines[i] = VK_NULL_HANDLE;
+    }
+    if (layer_pipeline) vkDestroyPipeline(device, layer_pipeline, nullptr);
+    layer_pipeline = VK_NULL_HANDLE;
+    if (render_pass) vkDestroyRenderPass(device, render_pass, nullptr);
+    render_pass = VK_NULL_HANDLE;
+}
+
+VkViewport AynThorScaler::get_viewport(Filter p_filter, int32_t p_src_width, int32_t p_src_height) const {
+    return compute_viewport(p_filter, target_extent, p_src_width, p_src_height, target_rotation);
+}
+
+VkViewport AynThorScaler::compute_viewport(Filter p_filter, VkExtent2D p_target_extent, int32_t p_src_width, int32_t p_src_height, int p_rotation) {
+    bool swap_axes = p_rotation == 90 || p_rotation == 270;
+    float dst_w = (float)p_target_extent.width;
+    float dst_h = (float)p_target_extent.height;
+    float src_w = (float)(swap_axes ? p_src_height : p_src_width);
+    float src_h = (float)(swap_axes ? p_src_width : p_src_height);
+
+    VkViewport viewport = {0.0f, 0.0f, dst_w, dst_h, 0.0f, 1.0f};
+    if (p_filter == FILTER_INTEGER) {
+        // Largest whole multiple that fits, centred; the clear letterboxes.
+        float factor = std::floor(std::min(dst_w / src_w, dst_h / src_h));
+        if (factor >= 1.0f) {
+            viewport.width = src_w * factor;
+            viewport.height = src_h * factor;
+            viewport.x = std::floor((dst_w - viewport.width) * 0.5f);
+            viewport.y = std::floor((dst_h - viewport.height) * 0.5f);
+        }
+    }
+    return viewport;
+}
+
+void AynThorScaler::map_source_rect(const VkViewport& p_viewport, int p_rotation, int32_t p_src_width, int32_t p_src_height, const float p_rect[4], float r_rect[4]) {
+    float x0, y0, x1, y1;
+    source_to_target(p_rotation, p_rect[0] / (float)p_src_width, p_rect[1] / (float)p_src_height, x0, y0);
+    source_to_target(p_rotation, (p_rect[0] + p_rect[2]) / (float)p_src_width, (p_rect[1] + p_rect[3]) / (float)p_src_height, x1, y1);
+    r_rect[0] = p_viewport.x + std::min(x0, x1) * p_viewport.width;
+    r_rect[1] = p_viewport.y + std::min(y0, y1) * p_viewport.height;
+    r_rect[2] = std::fabs(x1 - x0) * p_viewport.width;
+    r_rect[3] = std::fabs(y1 - y0) * p_viewport.height;
+}
+
+void AynThorScaler::_bind_view(uint32_t p_set, VkImageView p_view) {
+    // The slot's previous submission has retired, so its set can be rewritten.
+    if (bound_views[p_set] == p_view) return;
+
+    VkDescriptorImageInfo imageInfo = {};
+    imageInfo.imageView = p_view;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptor_sets[p_set];
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+    bound_views[p_set] = p_view;
+}
+
+void AynThorScaler::record(VkCommandBuffer p_cmd, uint32_t p_frame_slot, uint32_t p_image_index, VkImage p_source_image, VkImageView p_source_view, const AynThorImageState& p_source_state, int32_t p_src_width, int32_t p_src_height, Filter p_filter, float p_sharpness, const Layer* p_layers, uint32_t p_layer_count) {
+    if (p_frame_slot >= frame_slots || p_image_index >= framebuffers.size()) return;
+    if (p_layer_count > MAX_LAYERS) p_layer_count = MAX_LAYERS;
+
+    _bind_view(p_frame_slot, p_source_view);
+
+    // Every sampled image moves to SHADER_READ_ONLY_OPTIMAL once, however
+    // many layers read it.
+    VkImageMemoryBarrier barriers[MAX_LAYERS + 1] = {};
+    AynThorImageState states[MAX_LAYERS + 1];
+    VkPipelineStageFlags src_stages = 0;
+    uint32_t barrier_count = 0;
+    for (uint32_t i = 0; i <= p_layer_count; i++) {
+        VkImage image = i == 0 ? p_source_image : p_layers[i - 1].image;
+        const AynThorImageState &state = i == 0 ? p_source_state : p_layers[i - 1].state;
+        bool seen = false;
+        for (uint32_t j = 0; j < barrier_count && !seen; j++) seen = barriers[j].image == image;
+        if (seen || !image) continue;
+
+        VkImageMemoryBarrier &barrier = barriers[barrier_count];
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = state.layout;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.srcAccessMask = state.access;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        states[barrier_count] = state;
+        src_stages |= state.stage;
+        barrier_count++;
+    }
+
+    vkCmdPipelineBarrier(p_cmd, src_stages, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, barrier_count, barriers);
+
+    float src_w = (float)p_src_width;
+    float src_h = (float)p_src_height;
+    VkViewport viewport = get_viewport(p_filter, p_src_width, p_src_height);
+
+    Params params = {};
+    params.src_size[0] = src_w;
+    params.src_size[1] = src_h;
+    params.src_texel[0] = 1.0f / src_w;
+    params.src_texel[1] = 1.0f / src_h;
+    // Same 180 degree flip the blit path applies through its source offsets,
+    // plus the rotation the pre-transform could not do.
+    const float whole[4] = {0.0f, 0.0f, src_w, src_h};
+    _orient_params(target_rotation, whole, src_w, src_h, params);
+    bool swap_axes = target_rotation == 90 || target_rotation == 270;
+    params.prescale[0] = std::max(std::floor((swap_axes ? viewport.height : viewport.width) / src_w), 1.0f);
+    params.prescale[1] = std::max(std::floor((swap_axes ? viewport.width : viewport.height) / src_h), 1.0f);
+    params.sharpness = p_sharpness;
+    params.opacity = 1.0f;
+
+    VkClearValue clear = {};
+    VkRenderPassBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    beginInfo.renderPass = render_pass;
+    beginInfo.framebuffer = framebuffers[p_image_index];
+    beginInfo.renderArea.extent = target_extent;
+    beginInfo.clearValueCount = 1;
+    beginInfo.pClearValues = &clear;
+
+    VkRect2D scissor = {};
+    scissor.extent = target_extent;
+
+    vkCmdBeginRenderPass(p_cmd, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBindPipeline(p_cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[p_filter]);
+    vkCmdBindDescriptorSets(p_cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &descriptor_sets[p_frame_slot], 0, nullptr);
+    vkCmdPushConstants(p_cmd, pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(Params), &params);
+    vkCmdSetViewport(p_cmd, 0, 1, &viewport);
+    vkCmdSetScissor(p_cmd, 0, 1, &scissor);
+    vkCmdDraw(p_cmd, 3, 1, 0, 0);
+
+    // Layers are placed in source pixels, so they scale, flip and rotate
+    // with it.
+    bool layer_bound = false;
+    for (uint32_t i = 0; i < p_layer_count; i++) {
+        const Layer &layer = p_layers[i];
+        if (!layer.view || layer.width <= 0 || layer.height <= 0 || layer.opacity <= 0.0f) continue;
+        if (layer.src_rect[2] <= 0.0f || layer.src_rect[3] <= 0.0f || layer.dst_rect[2] <= 0.0f || layer.dst_rect[3] <= 0.0f) continue;
+
+        float target_rect[4];
+        map_source_rect(viewport, target_rotation, p_src_width, p_src_height, layer.dst_rect, target_rect);
+        VkViewport layer_viewport = {target_rect[0], target_rect[1], target_rect[2], target_rect[3], 0.0f, 1.0f};
+
+        float layer_w = (float)layer.width;
+        float layer_h = (float)layer.height;
+        Params layer_params = {};
+        layer_params.src_size[0] = layer_w;
+        layer_params.src_size[1] = layer_h;
+        layer_params.src_texel[0] = 1.0f / layer_w;
+        layer_params.src_texel[1] = 1.0f / layer_h;
+        _orient_params(target_rotation, layer.src_rect, layer_w, layer_h, layer_params);
+        layer_params.prescale[0] = 1.0f;
+        layer_params.prescale[1] = 1.0f;
+        layer_params.opacity = std::min(layer.opacity, 1.0f);
+
+        uint32_t set = frame_slots + p_frame_slot * MAX_LAYERS + i;
+        _bind_view(set, layer.view);
+
+        if (!layer_bound) {
+            vkCmdBindPipeline(p_cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layer_pipeline);
+            layer_bound = true;
+        }
+        vkCmdBindDescriptorSets(p_cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &descriptor_sets[set], 0, nullptr);
+        vkCmdPushConstants(p_cmd, pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(Params), &layer_params);
+        vkCmdSetViewport(p_cmd, 0, 1, &layer_viewport);
+        vkCmdDraw(p_cmd, 3, 1, 0, 0);
+    }
+    vkCmdEndRenderPass(p_cmd);
+
+    VkPipelineStageFlags dst_stages = 0;
+    for (uint32_t i = 0; i < barrier_count; i++) {
+        VkImageMemoryBarrier &barrier = barriers[i];
+        barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.newLayout = states[i].layout;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = states[i].access;
+        dst_stages |= states[i].stage;
+    }
+
+    vkCmdPipelineBarrier(p_cmd, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, dst_stages, 0, 0, nullptr, 0, nullptr, barrier_count, barriers);
+}
+
+#endif
+
+}
@@ -0,0 +1,131 @@
+#ifndef AYN_THOR_SCALER_H
+#define AYN_THOR_SCALER_H
+
+#include "ayn_thor_blit.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace godot {
+
+// Fragment-shader scaling pass used instead of vkCmdBlitImage. Owns the render
+// pass, pipelines and per-swapchain-image framebuffers; it has no dependency on
+// Godot so the renderer can drive it from its own threads.
+class AynThorScaler {
+public:
+    enum Filter {
+        FILTER_INTEGER,
+        FILTER_SHARP_BILINEAR,
+        FILTER_EDGE_ADAPTIVE,
+        FILTER_BILINEAR,
+        FILTER_MAX,
+    };
+
+    enum ShaderStage {
+        STAGE_VERTEX,
+        STAGE_FRAGMENT_INTEGER,
+        STAGE_FRAGMENT_SHARP_BILINEAR,
+        STAGE_FRAGMENT_EDGE_ADAPTIVE,
+        STAGE_FRAGMENT_BILINEAR,
+        STAGE_FRAGMENT_LAYER,
+        STAGE_MAX,
+    };
+
+    // Layers drawn over the source in the same render pass.
+    static const uint32_t MAX_LAYERS = 8;
+
+    // GLSL for each stage; the caller compiles it to SPIR-V.
+    static std::string get_shader_source(ShaderStage p_stage);
+
+    // The source is flipped by 180 degrees on its way into the target, then
+    // rotated clockwise by p_rotation (0, 90, 180 or 270). Maps a point of
+    // the drawn rect, 0..1 in target space, to the source UV it shows, and
+    // back.
+    static void target_to_source(int p_rotation, float p_x, float p_y, float& r_u, float& r_v);
+    static void source_to_target(int p_rotation, float p_u, float p_v, float& r_x, float& r_y);
+
+#ifdef __ANDROID__
+    struct Params {
+        float src_size[2];
+        float src_texel[2];
+        float uv_origin[2];
+        float uv_axis_x[2];
+        float uv_axis_y[2];
+        float prescale[2];
+        float sharpness;
+        float opacity;
+    };
+
+    // A texture blended over the source, in the source's orientation.
+    struct Layer {
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        AynThorImageState state;
+        int32_t width = 0;
+        int32_t height = 0;
+        // x, y, width, height in layer texels and in source pixels.
+        float src_rect[4] = {};
+        float dst_rect[4] = {};
+        float opacity = 1.0f;
+    };
+
+    bool init(VkDevice p_device, const std::vector<std::vector<uint32_t>>& p_spirv, const std::vector<uint8_t>& p_cache_data, uint32_t p_frame_slots);
+    void cleanup();
+
+    // Builds the render pass and pipelines on first use or when the format
+    // changes, plus views and framebuffers for the given swapchain images.
+    // p_rotation is the clockwise rotation the copy applies, see
+    // target_to_source().
+    bool set_target(VkFormat p_format, const std::vector<VkImage>& p_images, VkExtent2D p_extent, int p_rotation = 0);
+    // Drops the per-image views and framebuffers; pipelines stay cached.
+    // Must be called before the swapchain images are destroyed.
+    void release_target();
+
+    bool is_ready() const { return device != VK_NULL_HANDLE && render_pass != VK_NULL_HANDLE; }
+    std::vector<uint8_t> get_cache_data() const;
+
+    // Region of the target the source is drawn into.
+    VkViewport get_viewport(Filter p_filter, int32_t p_src_width, int32_t p_src_height) const;
+    static VkViewport compute_viewport(Filter p_filter, VkExtent2D p_target_extent, int32_t p_src_width, int32_t p_src_height, int p_rotation = 0);
+    // Target pixels a rect of source pixels (x, y, width, height) covers.
+    static void map_source_rect(const VkViewport& p_viewport, int p_rotation, int32_t p_src_width, int32_t p_src_height, const float p_rect[4], float r_rect[4]);
+
+    // Records the layout transitions of the source image and the layers, and
+    // the scaling pass into the swapchain image with the layers blended on
+    // top in z order. The image ends in PRESENT_SRC_KHR.
+    void record(VkCommandBuffer p_cmd, uint32_t p_frame_slot, uint32_t p_image_index, VkImage p_source_image, VkImageView p_source_view, const AynThorImageState& p_source_state, int32_t p_src_width, int32_t p_src_height, Filter p_filter, float p_sharpness, const Layer* p_layers = nullptr, uint32_t p_layer_count = 0);
+
+private:
+    VkDevice device = VK_NULL_HANDLE;
+    std::vector<std::vector<uint32_t>> spirv;
+
+    VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
+    VkDescriptorSetLayout descriptor_set_layout = VK_NULL_HANDLE;
+    VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+    // One set per frame slot for the source, then MAX_LAYERS per slot.
+    std::vector<VkDescriptorSet> descriptor_sets;
+    std::vector<VkImageView> bound_views;
+    uint32_t frame_slots = 0;
+    VkSampler sampler = VK_NULL_HANDLE;
+
+    VkFormat target_format = VK_FORMAT_UNDEFINED;
+    VkExtent2D target_extent = {0, 0};
+    int target_rotation = 0;
+    VkRenderPass render_pass = VK_NULL_HANDLE;
+    VkPipeline pipelines[FILTER_MAX] = {};
+    VkPipeline layer_pipeline = VK_NULL_HANDLE;
+    std::vector<VkImageView> target_views;
+    std::vector<VkFramebuffer> framebuffers;
+
+    bool _create_pipelines();
+    void _destroy_pipelines();
+    VkShaderModule _create_module(ShaderStage p_stage);
+    void _bind_view(uint32_t p_set, VkImageView p_view);
+#endif
+};
+
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef AYN_THOR_TOUCH_RING_H
+#define AYN_THOR_TOUCH_RING_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace godot {
+
+// One pointer sample as reported by MotionEvent, in second-window pixels.
+struct TouchSample {
+    int32_t action = 0;
+    int32_t pointer_id = 0;
+    float x = 0.0f;
+    float y = 0.0f;
+    // CLOCK_MONOTONIC, the clock MotionEvent times are taken from.
+    int64_t time_ns = 0;
+};
+
+// Bounded single-producer single-consumer queue. The Android UI thread pushes
+// from JNI, the main thread drains once per frame. When full, new samples are
+// dropped so the consumer never sees a torn sequence. Moves are dropped
+// first: the last RESERVED slots only take samples that change a pointer's
+// state, so a burst of moves cannot lose the UP or CANCEL that releases it.
+class TouchRing {
+public:
+    static const uint32_t CAPACITY = 1024;
+    // Room for an UP or CANCEL of every pointer, twice over.
+    static const uint32_t RESERVED = 64;
+    // MotionEvent.ACTION_MOVE, the only action that can be dropped without
+    // leaving a pointer in the wrong state.
+    static const int32_t ACTION_MOVE = 2;
+
+private:
+    static const uint32_t MASK = CAPACITY - 1;
+
+    TouchSample samples[CAPACITY];
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+
+public:
+    bool push(const TouchSample& p_sample) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t limit = p_sample.action == ACTION_MOVE ? CAPACITY - RESERVED : CAPACITY;
+        if (h - tail.load(std::memory_order_acquire) >= limit) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        samples[h & MASK] = p_sample;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(TouchSample& r_sample) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        r_sample = samples[t & MASK];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool is_empty() const {
+        return tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire);
+    }
+
+    uint64_t get_dropped_count() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+}
+
+#endif
\ No newline at end of file
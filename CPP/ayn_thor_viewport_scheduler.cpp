@@ -0,0 +1,54 @@
+#include "ayn_thor_viewport_scheduler.h"
+#include <algorithm>
+
+namespace godot {
+
+void AynThorViewportScheduler::configure(Policy p_policy, int p_main_divisor, int p_second_divisor) {
+    policy = p_policy;
+    main_divisor = (uint32_t)std::max(p_main_divisor, 1);
+    second_divisor = (uint32_t)std::max(p_second_divisor, 1);
+}
+
+AynThorViewportScheduler::Decision AynThorViewportScheduler::next(bool p_second_wanted, bool p_second_due, bool p_tight) {
+    main_age = std::min(main_age + 1, AGE_MAX);
+    second_age = std::min(second_age + 1, AGE_MAX);
+
+    Decision decision;
+    switch (policy) {
+        case POLICY_ALWAYS:
+            break;
+        case POLICY_DIVISOR:
+            decision.main = main_age >= main_divisor;
+            decision.second = second_age >= second_divisor;
+            break;
+        case POLICY_STAGGERED:
+            decision.main = main_age >= main_divisor;
+            decision.second = second_age >= second_divisor && p_second_wanted;
+            if (decision.main && decision.second && (p_tight || (main_divisor > 1 && second_divisor > 1))) {
+                // Ties go to the second viewport, the one that waits longer
+                // between updates anyway.
+                if (main_age - main_divisor > second_age - second_divisor) {
+                    decision.second = false;
+                } else {
+                    decision.main = false;
+                }
+            }
+            break;
+        case POLICY_VSYNC:
+            decision.main = main_age >= main_divisor;
+            decision.second = p_second_due;
+            break;
+    }
+    decision.second = decision.second && p_second_wanted;
+
+    if (decision.main) main_age = 0;
+    if (decision.second) second_age = 0;
+    return decision;
+}
+
+void AynThorViewportScheduler::reset() {
+    main_age = AGE_MAX;
+    second_age = AGE_MAX;
+}
+
+}
\ No newline at end of file
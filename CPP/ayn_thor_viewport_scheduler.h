@@ -0,0 +1,55 @@
+#ifndef AYN_THOR_VIEWPORT_SCHEDULER_H
+#define AYN_THOR_VIEWPORT_SCHEDULER_H
+
+#include <cstdint>
+
+namespace godot {
+
+// Decides, once per engine frame, which of the two viewports render. Each
+// viewport renders when it has waited its divisor's worth of frames, so a
+// deferred update shifts its phase instead of being lost.
+class AynThorViewportScheduler {
+public:
+    enum Policy {
+        // Both viewports every frame.
+        POLICY_ALWAYS,
+        // Each viewport every main/second divisor frames.
+        POLICY_DIVISOR,
+        // Like POLICY_DIVISOR, but when both are due in the same frame and
+        // that frame is over budget (or both divisors leave room), the more
+        // overdue one renders and the other moves to the next frame.
+        POLICY_STAGGERED,
+        // The main viewport by divisor; the second one whenever the caller
+        // reports a panel slot coming up.
+        POLICY_VSYNC,
+    };
+
+    struct Decision {
+        bool main = true;
+        bool second = true;
+    };
+
+    void configure(Policy p_policy, int p_main_divisor, int p_second_divisor);
+    Policy get_policy() const { return policy; }
+
+    // p_second_wanted false skips the second viewport under every policy.
+    // p_second_due is only read by POLICY_VSYNC and p_tight only by
+    // POLICY_STAGGERED.
+    Decision next(bool p_second_wanted, bool p_second_due, bool p_tight);
+
+    void reset();
+
+private:
+    static constexpr uint32_t AGE_MAX = 1u << 16;
+
+    Policy policy = POLICY_ALWAYS;
+    uint32_t main_divisor = 1;
+    uint32_t second_divisor = 1;
+    // Frames since each viewport last rendered.
+    uint32_t main_age = AGE_MAX;
+    uint32_t second_age = AGE_MAX;
+};
+
+}
+
+#endif
\ No newline at end of file
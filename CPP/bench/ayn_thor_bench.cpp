@@ -0,0 +1,620 @@
+// Headless benchmark of the second-screen copy and present path.
+//
+// Runs the renderer's frame ring, AynThorPresentRing (fence wait, acquire,
+// submit, present, SUBOPTIMAL handling and swapchain retirement), and its
+// blit against a VK_EXT_headless_surface swapchain, so it works on a
+// software driver such as lavapipe:
+//
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./aynthor_bench
+//
+// Built by build_plugin.sh when BUILD_BENCH=1.
+
+#include "../ayn_thor_blit.h"
+#include "../ayn_thor_frame_stats.h"
+#include "../ayn_thor_present_ring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace godot;
+
+static uint64_t _monotonic_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char* _present_mode_name(VkPresentModeKHR p_mode) {
+    switch (p_mode) {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: return "immediate";
+        case VK_PRESENT_MODE_MAILBOX_KHR: return "mailbox";
+        case VK_PRESENT_MODE_FIFO_KHR: return "fifo";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "fifo_relaxed";
+        default: return "other";
+    }
+}
+
+struct BenchConfig {
+    int32_t src_width = 0;
+    int32_t src_height = 0;
+    int32_t dst_width = 0;
+    int32_t dst_height = 0;
+    uint32_t frames_in_flight = 2;
+    VkPresentModeKHR present_mode = VK_PRESENT_MODE_FIFO_KHR;
+};
+
+struct BenchResult {
+    bool ok = false;
+    uint32_t frames_presented = 0;
+    double fps = 0.0;
+    AynThorFrameStats::Percentiles cpu_total;
+    AynThorFrameStats::Percentiles acquire;
+    AynThorFrameStats::Percentiles gpu_copy;
+    double recreate_avg_ms = 0.0;
+    double recreate_max_ms = 0.0;
+};
+
+class AynThorHeadlessBench {
+    VkInstance instance = VK_NULL_HANDLE;
+    VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+    uint32_t queue_family_index = 0;
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+    VkCommandPool command_pool = VK_NULL_HANDLE;
+
+    VkImage source_image = VK_NULL_HANDLE;
+    VkDeviceMemory source_memory = VK_NULL_HANDLE;
+
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+    VkFormat swapchain_format = VK_FORMAT_B8G8R8A8_UNORM;
+    VkColorSpaceKHR swapchain_color_space = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+    std::vector<VkImage> swapchain_images;
+    // Set when a present asks for a rebuild, like swapchain_dirty.
+    bool swapchain_dirty = false;
+    // Presents the swapchain accepted, SUBOPTIMAL ones included.
+    uint64_t presents = 0;
+
+    AynThorPresentRing ring;
+
+public:
+    std::string device_name;
+
+    bool init();
+    void cleanup();
+    std::vector<VkPresentModeKHR> get_present_modes() const;
+    BenchResult run(const BenchConfig& p_config, uint32_t p_frame_count, uint32_t p_recreate_count, AynThorFrameStats& r_stats);
+
+private:
+    uint32_t _find_memory_type(uint32_t p_type_bits, VkMemoryPropertyFlags p_flags) const;
+    bool _create_source(int32_t p_width, int32_t p_height);
+    void _destroy_source();
+    bool _create_swapchain(const BenchConfig& p_config);
+    void _destroy_swapchain();
+    bool _present_frame(const BenchConfig& p_config, AynThorFrameStats& r_stats);
+};
+
+bool AynThorHeadlessBench::init() {
+    const char* instance_extensions[] = {VK_KHR_SURFACE_EXTENSION_NAME, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME};
+
+    VkApplicationInfo appInfo = {};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "aynthor_bench";
+    appInfo.apiVersion = VK_API_VERSION_1_1;
+
+    VkInstanceCreateInfo instanceInfo = {};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pApplicationInfo = &appInfo;
+    instanceInfo.enabledExtensionCount = 2;
+    instanceInfo.ppEnabledExtensionNames = instance_extensions;
+
+    if (vkCreateInstance(&instanceInfo, nullptr, &instance) != VK_SUCCESS) {
+        std::fprintf(stderr, "aynthor_bench: vkCreateInstance failed (is VK_EXT_headless_surface available?)\n");
+        return false;
+    }
+
+    PFN_vkCreateHeadlessSurfaceEXT create_headless_surface = (PFN_vkCreateHeadlessSurfaceEXT)vkGetInstanceProcAddr(instance, "vkCreateHeadlessSurfaceEXT");
+    VkHeadlessSurfaceCreateInfoEXT surfaceInfo = {};
+    surfaceInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+    if (!create_headless_surface || create_headless_surface(instance, &surfaceInfo, nullptr, &surface) != VK_SUCCESS) {
+        std::fprintf(stderr, "aynthor_bench: could not create a headless surface\n");
+        return false;
+    }
+
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+    std::vector<VkPhysicalDevice> devices(deviceCount);
+    if (deviceCount > 0) {
+        vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+    }
+
+    // First device with a graphics queue that can present to the surface.
+    for (VkPhysicalDevice candidate : devices) {
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        if (familyCount > 0) {
+            vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, families.data());
+        }
+        for (uint32_t i = 0; i < familyCount; i++) {
+            VkBool32 present_supported = VK_FALSE;
+            vkGetPhysicalDeviceSurfaceSupportKHR(candidate, i, surface, &present_supported);
+            if ((families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) && present_supported) {
+                physical_device = candidate;
+                queue_family_index = i;
+                break;
+            }
+        }
+        if (physical_device) break;
+    }
+    if (!physical_device) {
+        std::fprintf(stderr, "aynthor_bench: no device can present to a headless surface\n");
+        return false;
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physical_device, &properties);
+    device_name = properties.deviceName;
+
+    float priority = 1.0f;
+    VkDeviceQueueCreateInfo queueInfo = {};
+    queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo.queueFamilyIndex = queue_family_index;
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &priority;
+
+    const char* device_extensions[] = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+    VkDeviceCreateInfo deviceInfo = {};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.queueCreateInfoCount = 1;
+    deviceInfo.pQueueCreateInfos = &queueInfo;
+    deviceInfo.enabledExtensionCount = 1;
+    deviceInfo.ppEnabledExtensionNames = device_extensions;
+
+    if (vkCreateDevice(physical_device, &deviceInfo, nullptr, &device) != VK_SUCCESS) {
+        std::fprintf(stderr, "aynthor_bench: vkCreateDevice failed\n");
+        return false;
+    }
+    vkGetDeviceQueue(device, queue_family_index, 0, &queue);
+
+    VkCommandPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = queue_family_index;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &command_pool) != VK_SUCCESS) {
+        return false;
+    }
+
+    ring.init(physical_device, device);
+    ring.create_timestamps(queue_family_index);
+
+    uint32_t formatCount = 0;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &formatCount, nullptr);
+    std::vector<VkSurfaceFormatKHR> formats(formatCount);
+    if (formatCount > 0) {
+        vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &formatCount, formats.data());
+        swapchain_format = formats[0].format;
+        swapchain_color_space = formats[0].colorSpace;
+    }
+    for (const VkSurfaceFormatKHR& format : formats) {
+        if (format.format == VK_FORMAT_R8G8B8A8_UNORM) {
+            swapchain_format = format.format;
+            swapchain_color_space = format.colorSpace;
+            break;
+        }
+    }
+    return true;
+}
+
+void AynThorHeadlessBench::cleanup() {
+    if (device) {
+        vkDeviceWaitIdle(device);
+        ring.destroy_slots();
+        _destroy_swapchain();
+        _destroy_source();
+        ring.destroy_timestamps();
+        if (command_pool) vkDestroyCommandPool(device, command_pool, nullptr);
+        vkDestroyDevice(device, nullptr);
+    }
+    if (surface) vkDestroySurfaceKHR(instance, surface, nullptr);
+    if (instance) vkDestroyInstance(instance, nullptr);
+    command_pool = VK_NULL_HANDLE;
+    device = VK_NULL_HANDLE;
+    surface = VK_NULL_HANDLE;
+    instance = VK_NULL_HANDLE;
+}
+
+std::vector<VkPresentModeKHR> AynThorHeadlessBench::get_present_modes() const {
+    uint32_t presentModeCount = 0;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &presentModeCount, nullptr);
+    std::vector<VkPresentModeKHR> presentModes(presentModeCount);
+    if (presentModeCount > 0) {
+        vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &presentModeCount, presentModes.data());
+    }
+    return presentModes;
+}
+
+uint32_t AynThorHeadlessBench::_find_memory_type(uint32_t p_type_bits, VkMemoryPropertyFlags p_flags) const {
+    VkPhysicalDeviceMemoryProperties memory_properties;
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++) {
+        if ((p_type_bits & (1u << i)) && (memory_properties.memoryTypes[i].propertyFlags & p_flags) == p_flags) {
+            return i;
+        }
+    }
+    return UINT32_MAX;
+}
+
+bool AynThorHeadlessBench::_create_source(int32_t p_width, int32_t p_height) {
+    // Stands in for the second SubViewport's render target.
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.extent = {(uint32_t)p_width, (uint32_t)p_height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if (vkCreateImage(device, &imageInfo, nullptr, &source_image) != VK_SUCCESS) return false;
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(device, source_image, &requirements);
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = requirements.size;
+    allocInfo.memoryTypeIndex = _find_memory_type(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (allocInfo.memoryTypeIndex == UINT32_MAX) {
+        allocInfo.memoryTypeIndex = _find_memory_type(requirements.memoryTypeBits, 0);
+    }
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &source_memory) != VK_SUCCESS) return false;
+    if (vkBindImageMemory(device, source_image, source_memory, 0) != VK_SUCCESS) return false;
+
+    // Clear once and leave it in the layout Godot hands the renderer.
+    VkCommandBufferAllocateInfo cmdInfo = {};
+    cmdInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdInfo.commandPool = command_pool;
+    cmdInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdInfo.commandBufferCount = 1;
+    VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+    if (vkAllocateCommandBuffers(device, &cmdInfo, &command_buffer) != VK_SUCCESS) return false;
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(command_buffer, &beginInfo);
+
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = source_image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkClearColorValue color = {};
+    color.float32[0] = 0.2f;
+    color.float32[1] = 0.4f;
+    color.float32[2] = 0.8f;
+    color.float32[3] = 1.0f;
+    vkCmdClearColorImage(command_buffer, source_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &color, 1, &barrier.subresourceRange);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    vkEndCommandBuffer(command_buffer);
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &command_buffer;
+    bool ok = vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) == VK_SUCCESS;
+    vkQueueWaitIdle(queue);
+    vkFreeCommandBuffers(device, command_pool, 1, &command_buffer);
+    return ok;
+}
+
+void AynThorHeadlessBench::_destroy_source() {
+    if (source_image) vkDestroyImage(device, source_image, nullptr);
+    if (source_memory) vkFreeMemory(device, source_memory, nullptr);
+    source_image = VK_NULL_HANDLE;
+    source_memory = VK_NULL_HANDLE;
+}
+
+bool AynThorHeadlessBench::_create_swapchain(const BenchConfig& p_config) {
+    VkSurfaceCapabilitiesKHR capabilities;
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physical_device, surface, &capabilities);
+
+    VkSwapchainCreateInfoKHR createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    createInfo.surface = surface;
+    createInfo.minImageCount = capabilities.minImageCount + 1;
+    if (capabilities.maxImageCount > 0 && createInfo.minImageCount > capabilities.maxImageCount) {
+        createInfo.minImageCount = capabilities.maxImageCount;
+    }
+    createInfo.imageFormat = swapchain_format;
+    createInfo.imageColorSpace = swapchain_color_space;
+    createInfo.imageExtent = {(uint32_t)p_config.dst_width, (uint32_t)p_config.dst_height};
+    createInfo.imageArrayLayers = 1;
+    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    createInfo.preTransform = capabilities.currentTransform;
+    createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    createInfo.presentMode = p_config.present_mode;
+    createInfo.clipped = VK_TRUE;
+    createInfo.oldSwapchain = swapchain;
+
+    // Retired like the renderer does it: the old swapchain lives on until
+    // the ring sees the new one's presents come back.
+    VkSwapchainKHR old_swapchain = swapchain;
+    VkResult res = vkCreateSwapchainKHR(device, &createInfo, nullptr, &swapchain);
+    ring.retire_swapchain(old_swapchain);
+    swapchain_images.clear();
+    swapchain_dirty = false;
+    if (res != VK_SUCCESS) {
+        swapchain = VK_NULL_HANDLE;
+        return false;
+    }
+
+    uint32_t imageCount = 0;
+    vkGetSwapchainImagesKHR(device, swapchain, &imageCount, nullptr);
+    swapchain_images.resize(imageCount);
+    vkGetSwapchainImagesKHR(device, swapchain, &imageCount, swapchain_images.data());
+    ring.swapchain_created(surface, imageCount, capabilities);
+    return true;
+}
+
+void AynThorHeadlessBench::_destroy_swapchain() {
+    ring.destroy_retired_swapchains();
+    if (swapchain) vkDestroySwapchainKHR(device, swapchain, nullptr);
+    swapchain = VK_NULL_HANDLE;
+    swapchain_images.clear();
+    ring.forget_images();
+}
+
+bool AynThorHeadlessBench::_present_frame(const BenchConfig& p_config, AynThorFrameStats& r_stats) {
+    // A stale swapchain is rebuilt before the acquire, as in the renderer.
+    if (swapchain_dirty) {
+        ring.wait_slots(UINT64_MAX);
+        if (!_create_swapchain(p_config)) return false;
+    }
+
+    AynThorFrameStats::FrameTiming timing;
+    ring.wait_slot(timing);
+    uint32_t imageIndex;
+    AynThorPresentRing::Result result = ring.acquire(swapchain, UINT64_MAX, timing, imageIndex);
+    if (result == AynThorPresentRing::RESULT_OUT_OF_DATE) {
+        swapchain_dirty = true;
+        return true;
+    } else if (result != AynThorPresentRing::RESULT_OK) {
+        return false;
+    }
+
+    AynThorPresentRing::Slot &slot = ring.get_current();
+    VkCommandBuffer command_buffer = slot.command_buffer;
+    uint64_t record_start = _monotonic_ns();
+    vkResetCommandBuffer(command_buffer, 0);
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    vkBeginCommandBuffer(command_buffer, &beginInfo);
+    ring.write_start_timestamp(command_buffer);
+    AynThorBlit::record(command_buffer, source_image, AynThorImageState(), p_config.src_width, p_config.src_height, swapchain_images[imageIndex], p_config.dst_width, p_config.dst_height);
+    ring.write_end_timestamp(command_buffer);
+    vkEndCommandBuffer(command_buffer);
+    uint64_t submit_start = _monotonic_ns();
+    timing.usec[AynThorFrameStats::METRIC_RECORD] = (double)(submit_start - record_start) / 1000.0;
+
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &slot.image_available_semaphore;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &command_buffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &slot.render_finished_semaphore;
+
+    VkFence fence = ring.begin_submit();
+    if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS) return false;
+    VkSemaphore render_finished = slot.render_finished_semaphore;
+    ring.end_submit(true, timing.start_ns);
+
+    VkPresentInfoKHR presentInfo = {};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &render_finished;
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &swapchain;
+    presentInfo.pImageIndices = &imageIndex;
+
+    result = ring.present(queue, presentInfo, submit_start, timing);
+    r_stats.record(timing);
+    if (result == AynThorPresentRing::RESULT_OK || result == AynThorPresentRing::RESULT_SUBOPTIMAL) {
+        presents++;
+    }
+    if (result == AynThorPresentRing::RESULT_OUT_OF_DATE || result == AynThorPresentRing::RESULT_SUBOPTIMAL) {
+        swapchain_dirty = true;
+    }
+    return result == AynThorPresentRing::RESULT_OK || result == AynThorPresentRing::RESULT_SUBOPTIMAL || result == AynThorPresentRing::RESULT_OUT_OF_DATE;
+}
+
+BenchResult AynThorHeadlessBench::run(const BenchConfig& p_config, uint32_t p_frame_count, uint32_t p_recreate_count, AynThorFrameStats& r_stats) {
+    BenchResult result;
+    r_stats.reset();
+    if (!_create_source(p_config.src_width, p_config.src_height) || !_create_swapchain(p_config) || !ring.create_slots(command_pool, p_config.frames_in_flight)) {
+        ring.destroy_slots();
+        _destroy_swapchain();
+        _destroy_source();
+        return result;
+    }
+
+    // A short warm-up keeps first-use costs out of the distribution.
+    for (uint32_t i = 0; i < 10 && _present_frame(p_config, r_stats); i++) {}
+    r_stats.reset();
+
+    result.ok = true;
+    uint64_t start = _monotonic_ns();
+    uint64_t presents_before = presents;
+    for (uint32_t i = 0; i < p_frame_count; i++) {
+        if (!_present_frame(p_config, r_stats)) {
+            result.ok = false;
+            break;
+        }
+    }
+    ring.wait_slots(UINT64_MAX);
+    // Only what reached the swapchain counts, also after an early stop or
+    // an out-of-date acquire.
+    result.frames_presented = (uint32_t)(presents - presents_before);
+    double seconds = (double)(_monotonic_ns() - start) / 1e9;
+    result.fps = seconds > 0.0 ? (double)result.frames_presented / seconds : 0.0;
+    result.cpu_total = r_stats.get_percentiles(AynThorFrameStats::METRIC_CPU_TOTAL);
+    result.acquire = r_stats.get_percentiles(AynThorFrameStats::METRIC_ACQUIRE);
+    result.gpu_copy = r_stats.get_percentiles(AynThorFrameStats::METRIC_GPU_COPY);
+
+    // Recreation as the renderer does it on resize: drain the ring, build
+    // the new swapchain from the old one and get the first frame out.
+    AynThorFrameStats scratch_stats;
+    double total_ms = 0.0;
+    uint32_t recreated = 0;
+    for (uint32_t i = 0; result.ok && i < p_recreate_count; i++) {
+        uint64_t recreate_start = _monotonic_ns();
+        ring.wait_slots(UINT64_MAX);
+        if (!_create_swapchain(p_config) || !_present_frame(p_config, scratch_stats)) {
+            result.ok = false;
+            break;
+        }
+        double ms = (double)(_monotonic_ns() - recreate_start) / 1e6;
+        total_ms += ms;
+        recreated++;
+        result.recreate_max_ms = std::max(result.recreate_max_ms, ms);
+    }
+    if (recreated > 0) result.recreate_avg_ms = total_ms / (double)recreated;
+
+    ring.destroy_slots();
+    _destroy_swapchain();
+    _destroy_source();
+    return result;
+}
+
+static void _print_usage() {
+    std::printf("usage: aynthor_bench [--frames N] [--recreate N] [--quick] [--csv FILE] [--trace FILE]\n");
+}
+
+int main(int argc, char** argv) {
+    uint32_t frame_count = 300;
+    uint32_t recreate_count = 10;
+    bool quick = false;
+    std::string csv_path;
+    std::string trace_path;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--frames" && has_value) {
+            frame_count = (uint32_t)std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--recreate" && has_value) {
+            recreate_count = (uint32_t)std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--quick") {
+            quick = true;
+        } else if (arg == "--csv" && has_value) {
+            csv_path = argv[++i];
+        } else if (arg == "--trace" && has_value) {
+            trace_path = argv[++i];
+        } else {
+            _print_usage();
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+
+    AynThorHeadlessBench bench;
+    if (!bench.init()) {
+        bench.cleanup();
+        return 1;
+    }
+    std::printf("aynthor_bench on %s\n", bench.device_name.c_str());
+
+    // The manager's default second viewport, then larger sources onto the
+    // Thor's bottom panel and a 1080p external display.
+    std::vector<VkExtent2D> sources = {{854, 480}, {1280, 720}, {1920, 1080}};
+    std::vector<VkExtent2D> targets = {{1080, 1240}, {1920, 1080}};
+    std::vector<uint32_t> depths = {1, 2, 3};
+    std::vector<VkPresentModeKHR> wanted_modes = {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR};
+    if (quick) {
+        sources.resize(1);
+        targets.resize(1);
+        depths = {2};
+        wanted_modes.resize(1);
+    }
+
+    std::vector<VkPresentModeKHR> supported_modes = bench.get_present_modes();
+    std::vector<VkPresentModeKHR> modes;
+    for (VkPresentModeKHR mode : wanted_modes) {
+        if (std::find(supported_modes.begin(), supported_modes.end(), mode) != supported_modes.end()) modes.push_back(mode);
+    }
+
+    FILE* csv = nullptr;
+    if (!csv_path.empty()) {
+        csv = std::fopen(csv_path.c_str(), "w");
+        if (csv) std::fprintf(csv, "src,dst,frames_in_flight,present_mode,fps,cpu_p50_us,cpu_p95_us,cpu_p99_us,acquire_p95_us,gpu_p50_us,gpu_p95_us,gpu_p99_us,recreate_avg_ms,recreate_max_ms\n");
+    }
+
+    // Every frame of every configuration goes to one trace when asked for.
+    AynThorFrameStats stats;
+    if (!trace_path.empty() && !stats.start_trace(trace_path, trace_path.size() > 5 && trace_path.compare(trace_path.size() - 5, 5, ".json") == 0 ? AynThorFrameStats::TRACE_CHROME : AynThorFrameStats::TRACE_CSV)) {
+        std::fprintf(stderr, "aynthor_bench: could not open %s\n", trace_path.c_str());
+    }
+
+    std::printf("%-10s %-10s %3s %-10s %9s %26s %9s %20s %17s\n", "src", "dst", "fif", "mode", "fps", "cpu p50/p95/p99 us", "acq p95", "gpu p50/p95 us", "recreate avg/max");
+    int failures = 0;
+    for (const VkExtent2D& source : sources) {
+        for (const VkExtent2D& target : targets) {
+            for (uint32_t depth : depths) {
+                for (VkPresentModeKHR mode : modes) {
+                    BenchConfig config;
+                    config.src_width = (int32_t)source.width;
+                    config.src_height = (int32_t)source.height;
+                    config.dst_width = (int32_t)target.width;
+                    config.dst_height = (int32_t)target.height;
+                    config.frames_in_flight = depth;
+                    config.present_mode = mode;
+
+                    BenchResult result = bench.run(config, frame_count, recreate_count, stats);
+                    char src_name[32];
+                    char dst_name[32];
+                    std::snprintf(src_name, sizeof(src_name), "%ux%u", source.width, source.height);
+                    std::snprintf(dst_name, sizeof(dst_name), "%ux%u", target.width, target.height);
+                    if (!result.ok) {
+                        failures++;
+                        std::printf("%-10s %-10s %3u %-10s FAILED\n", src_name, dst_name, depth, _present_mode_name(mode));
+                        continue;
+                    }
+                    std::printf("%-10s %-10s %3u %-10s %9.1f %8.0f/%8.0f/%8.0f %9.0f %9.0f/%10.0f %7.2f/%7.2f ms\n", src_name, dst_name, depth, _present_mode_name(mode), result.fps,
+                            result.cpu_total.p50, result.cpu_total.p95, result.cpu_total.p99, result.acquire.p95, result.gpu_copy.p50, result.gpu_copy.p95, result.recreate_avg_ms, result.recreate_max_ms);
+                    if (csv) {
+                        std::fprintf(csv, "%s,%s,%u,%s,%.2f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.3f,%.3f\n", src_name, dst_name, depth, _present_mode_name(mode), result.fps,
+                                result.cpu_total.p50, result.cpu_total.p95, result.cpu_total.p99, result.acquire.p95, result.gpu_copy.p50, result.gpu_copy.p95, result.gpu_copy.p99, result.recreate_avg_ms, result.recreate_max_ms);
+                    }
+                }
+            }
+        }
+    }
+
+    stats.stop_trace();
+    if (csv) std::fclose(csv);
+    bench.cleanup();
+    return failures > 0 ? 1 : 0;
+}
\ No newline at end of file
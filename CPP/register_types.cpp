@@ -1,4 +1,5 @@
 #include "register_types.h"
+#include "ayn_thor_direct_interface.h"
 #include "ayn_thor_renderer.h"
 #include <gdextension_interface.h>
 #include <godot_cpp/core/defs.hpp>
@@ -11,6 +12,7 @@ void initialize_aynthor_module(ModuleInitializationLevel p_level) {
         return;
     }
     ClassDB::register_class<AynThorRenderer>();
+    ClassDB::register_class<AynThorDirectInterface>();
 }
 
 void uninitialize_aynthor_module(ModuleInitializationLevel p_level) {}
@@ -0,0 +1,84 @@
+// Unit test of TouchRing. Header-only and free of Godot, so it builds with
+// the host compiler alone:
+//
+//   g++ -std=c++17 -I.. ayn_thor_touch_ring_test.cpp
+//
+// Built and run by build_plugin.sh.
+
+#include "../ayn_thor_touch_ring.h"
+
+#include <cstdio>
+
+using namespace godot;
+
+static const int32_t ACTION_DOWN = 0;
+static const int32_t ACTION_UP = 1;
+static const int32_t ACTION_CANCEL = 3;
+
+static int failures = 0;
+
+static void _check(bool p_condition, const char* p_what) {
+    if (p_condition) return;
+    std::fprintf(stderr, "FAIL: %s\n", p_what);
+    failures++;
+}
+
+static TouchSample _sample(int32_t p_action, int32_t p_pointer_id) {
+    TouchSample sample;
+    sample.action = p_action;
+    sample.pointer_id = p_pointer_id;
+    return sample;
+}
+
+// A burst of moves fills the ring; the release pushed after it still has
+// to come out last.
+static void _test_release_after_move_burst() {
+    static TouchRing ring;
+    _check(ring.push(_sample(ACTION_DOWN, 0)), "down is queued");
+    uint32_t moves = 0;
+    for (uint32_t i = 0; i < TouchRing::CAPACITY * 2; i++) {
+        if (ring.push(_sample(TouchRing::ACTION_MOVE, 0))) moves++;
+    }
+    _check(moves < TouchRing::CAPACITY - 1, "moves stop short of the reserve");
+    _check(ring.get_dropped_count() > 0, "excess moves are dropped");
+    _check(ring.push(_sample(ACTION_UP, 0)), "up is queued into a full ring");
+
+    TouchSample sample;
+    TouchSample last;
+    uint32_t count = 0;
+    while (ring.pop(sample)) {
+        last = sample;
+        count++;
+    }
+    _check(count == moves + 2, "every queued sample comes out");
+    _check(last.action == ACTION_UP && last.pointer_id == 0, "the release arrives last");
+}
+
+// Every pointer can still be cancelled when moves filled the ring.
+static void _test_cancel_every_pointer() {
+    static TouchRing ring;
+    for (uint32_t i = 0; i < TouchRing::CAPACITY; i++) {
+        ring.push(_sample(TouchRing::ACTION_MOVE, (int32_t)(i % 10)));
+    }
+    bool queued = true;
+    for (int32_t pointer = 0; pointer < 32; pointer++) {
+        queued = ring.push(_sample(ACTION_CANCEL, pointer)) && queued;
+    }
+    _check(queued, "a cancel of every pointer fits the reserve");
+
+    TouchSample sample;
+    int32_t cancels = 0;
+    while (ring.pop(sample)) {
+        if (sample.action == ACTION_CANCEL) cancels++;
+    }
+    _check(cancels == 32, "every cancel arrives");
+    _check(ring.is_empty(), "ring drains");
+}
+
+int main() {
+    _test_release_after_move_burst();
+    _test_cancel_every_pointer();
+    if (failures) return 1;
+    std::printf("ayn_thor_touch_ring_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Unit test of AynThorViewportScheduler. It has no dependency on Godot, so
+// it builds with the host compiler alone:
+//
+//   g++ -std=c++17 -I.. ayn_thor_viewport_scheduler_test.cpp ../ayn_thor_viewport_scheduler.cpp
+//
+// Built and run by build_plugin.sh.
+
+#include "../ayn_thor_viewport_scheduler.h"
+
+#include <cstdio>
+
+using namespace godot;
+
+static int failures = 0;
+
+static void _check(bool p_condition, const char* p_what, int p_frame) {
+    if (p_condition) return;
+    std::fprintf(stderr, "FAIL: %s (frame %d)\n", p_what, p_frame);
+    failures++;
+}
+
+static void _test_always() {
+    AynThorViewportScheduler scheduler;
+    scheduler.configure(AynThorViewportScheduler::POLICY_ALWAYS, 3, 3);
+    for (int frame = 0; frame < 4; frame++) {
+        AynThorViewportScheduler::Decision decision = scheduler.next(frame != 2, false, true);
+        _check(decision.main, "always: main renders", frame);
+        _check(decision.second == (frame != 2), "always: second renders when wanted", frame);
+    }
+}
+
+static void _test_divisor() {
+    AynThorViewportScheduler scheduler;
+    scheduler.configure(AynThorViewportScheduler::POLICY_DIVISOR, 1, 3);
+    for (int frame = 0; frame < 7; frame++) {
+        AynThorViewportScheduler::Decision decision = scheduler.next(true, false, false);
+        _check(decision.main, "divisor: main every frame", frame);
+        _check(decision.second == (frame % 3 == 0), "divisor: second every third frame", frame);
+    }
+
+    // A skipped update shifts the phase instead of being lost.
+    scheduler.reset();
+    scheduler.configure(AynThorViewportScheduler::POLICY_DIVISOR, 1, 2);
+    const bool wanted[] = {true, false, false, true, true, true};
+    const bool expected[] = {true, false, false, true, false, true};
+    for (int frame = 0; frame < 6; frame++) {
+        AynThorViewportScheduler::Decision decision = scheduler.next(wanted[frame], false, false);
+        _check(decision.second == expected[frame], "divisor: deferred second keeps its phase", frame);
+    }
+}
+
+static void _test_staggered() {
+    AynThorViewportScheduler scheduler;
+    scheduler.configure(AynThorViewportScheduler::POLICY_STAGGERED, 1, 1);
+
+    // Over budget, only one renders per frame; the tie goes to the second.
+    AynThorViewportScheduler::Decision decision = scheduler.next(true, false, true);
+    _check(!decision.main && decision.second, "staggered: tie goes to second", 0);
+    decision = scheduler.next(true, false, true);
+    _check(decision.main && !decision.second, "staggered: overdue main goes next", 1);
+    decision = scheduler.next(true, false, true);
+    _check(!decision.main && decision.second, "staggered: then the second again", 2);
+
+    // Within budget and with a divisor of one, both render.
+    decision = scheduler.next(true, false, false);
+    _check(decision.main && decision.second, "staggered: both fit", 3);
+}
+
+static void _test_vsync() {
+    AynThorViewportScheduler scheduler;
+    scheduler.configure(AynThorViewportScheduler::POLICY_VSYNC, 2, 1);
+    const bool due[] = {true, false, true, true};
+    for (int frame = 0; frame < 4; frame++) {
+        AynThorViewportScheduler::Decision decision = scheduler.next(true, due[frame], false);
+        _check(decision.main == (frame % 2 == 0), "vsync: main by divisor", frame);
+        _check(decision.second == due[frame], "vsync: second when a slot is due", frame);
+    }
+    AynThorViewportScheduler::Decision decision = scheduler.next(false, true, false);
+    _check(!decision.second, "vsync: unwanted second is skipped", 4);
+}
+
+int main() {
+    _test_always();
+    _test_divisor();
+    _test_staggered();
+    _test_vsync();
+    if (failures) return 1;
+    std::printf("ayn_thor_viewport_scheduler_test: ok\n");
+    return 0;
+}
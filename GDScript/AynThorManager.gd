@@ -4,17 +4,165 @@ extends Node
 @export var main_screen: Screen
 @export var second_screen: Screen
 
+@export var display_id: int = -1:
+	set(value):
+		display_id = value
+		if renderer:
+			renderer.set_display_id(value)
+
 @export var target_fps: int = 0:
 	set(value):
 		target_fps = value
 		if renderer:
 			renderer.set_target_fps(value)
 
+@export_range(0, 8) var refresh_divisor: int = 0:
+	set(value):
+		refresh_divisor = value
+		if renderer:
+			renderer.set_refresh_divisor(value)
+
+@export var present_mode: PresentMode = PresentMode.LOW_LATENCY:
+	set(value):
+		present_mode = value
+		if renderer:
+			renderer.set_present_mode_policy(value)
+
+@export var swapchain_format: SwapchainFormat = SwapchainFormat.RGBA8:
+	set(value):
+		swapchain_format = value
+		if renderer:
+			renderer.set_swapchain_format(value)
+
+@export_range(0, 8) var swapchain_image_count: int = 0:
+	set(value):
+		swapchain_image_count = value
+		if renderer:
+			renderer.set_swapchain_image_count(value)
+
+@export_range(1, 4) var frames_in_flight: int = 2:
+	set(value):
+		frames_in_flight = value
+		if renderer:
+			renderer.set_frames_in_flight(value)
+
+@export var threaded_present: bool = false:
+	set(value):
+		threaded_present = value
+		if renderer:
+			renderer.set_threaded_present(value)
+
+@export var frame_policy: FramePolicy = FramePolicy.DROP:
+	set(value):
+		frame_policy = value
+		if renderer:
+			renderer.set_frame_policy(value)
+
+@export var scale_mode: ScaleMode = ScaleMode.BLIT:
+	set(value):
+		scale_mode = value
+		if renderer:
+			renderer.set_scale_mode(value)
+
+@export_range(0.0, 1.0, 0.01) var sharpness: float = 0.5:
+	set(value):
+		sharpness = value
+		if renderer:
+			renderer.set_sharpness(value)
+
+# RESIZE unless the resolution loss of a scale-only swap is acceptable.
+@export var swap_mode: SwapMode = SwapMode.RESIZE
+
+@export var dirty_tracking: bool = false:
+	set(value):
+		dirty_tracking = value
+		_apply_second_update_mode()
+
+@export var update_policy: UpdatePolicy = UpdatePolicy.ALWAYS:
+	set(value):
+		update_policy = value
+		if renderer:
+			renderer.set_update_policy(value)
+
+@export_range(1, 8) var main_update_divisor: int = 1:
+	set(value):
+		main_update_divisor = value
+		if renderer:
+			renderer.set_main_update_divisor(value)
+
+@export_range(1, 8) var second_update_divisor: int = 1:
+	set(value):
+		second_update_divisor = value
+		if renderer:
+			renderer.set_second_update_divisor(value)
+
+@export var performance_monitors: bool = false:
+	set(value):
+		performance_monitors = value
+		if renderer:
+			renderer.set_performance_monitors(value)
+
+@export var latency_probe: bool = false:
+	set(value):
+		latency_probe = value
+		if renderer:
+			renderer.set_latency_probe(value)
+
+@export var direct_mode: bool = false:
+	set(value):
+		direct_mode = value
+		if renderer:
+			renderer.set_direct_mode(value)
+
+@export var dynamic_resolution: bool = false:
+	set(value):
+		dynamic_resolution = value
+		if renderer:
+			renderer.set_dynamic_resolution(value)
+		if not value:
+			_apply_resolution_scale(1.0)
+
+@export_range(0.25, 1.0, 0.05) var dynamic_resolution_min: float = 0.5:
+	set(value):
+		dynamic_resolution_min = value
+		if renderer:
+			renderer.set_dynamic_resolution_min_scale(value)
+
+@export_range(0.25, 1.0, 0.05) var dynamic_resolution_max: float = 1.0:
+	set(value):
+		dynamic_resolution_max = value
+		if renderer:
+			renderer.set_dynamic_resolution_max_scale(value)
+
+@export_range(0.5, 33.0, 0.5) var gpu_budget_ms: float = 4.0:
+	set(value):
+		gpu_budget_ms = value
+		if renderer:
+			renderer.set_gpu_budget_ms(value)
+
+@export_range(0, 240) var capture_fps: int = 0:
+	set(value):
+		capture_fps = value
+		if renderer:
+			renderer.set_capture_fps(value)
+
+@export_range(0.1, 1.0, 0.05) var capture_scale: float = 1.0:
+	set(value):
+		capture_scale = value
+		if renderer:
+			renderer.set_capture_scale(value)
+
 @export var rotation_degrees: ScreenRotation = ScreenRotation.DEG_180:
 	set(value):
 		rotation_degrees = value
 		if renderer:
 			renderer.set_rotation_degrees(value)
+
+@export var compositor_rotation: bool = false:
+	set(value):
+		compositor_rotation = value
+		if renderer:
+			renderer.set_compositor_rotation(value)
 			
 var _main_viewport: SubViewport
 var _second_viewport: SubViewport
@@ -29,7 +177,11 @@ var original_main_size: Vector2i
 var original_second_size: Vector2i
 var is_android: bool = false
 var second_size_confirmed: bool = false
-var last_touch_positions: Dictionary = {}
+
+var _second_dirty: bool = true
+var _second_damage: Rect2i = Rect2i()
+var _second_render_damage: Rect2i = Rect2i()
+var _present_after_swap: bool = false
 
 signal screens_swapped(swapped: bool)
 
@@ -53,7 +205,8 @@ func _ready():
 		
 		ayn_thor_plugin = Engine.get_singleton("AynThor")
 		ayn_thor_plugin.connect("second_screen_connected", _on_screen_connected)
-		ayn_thor_plugin.connect("second_screen_input", _on_second_screen_input)
+		# Touches come from renderer.flush_touch_input(); skip the per-event signal.
+		ayn_thor_plugin.set_input_signal_enabled(false)
 		ayn_thor_plugin.init_screen()
 	
 	if ClassDB.class_exists("AynThorRenderer"):
@@ -62,8 +215,31 @@ func _ready():
 			renderer = ClassDB.instantiate("AynThorRenderer")
 			add_child(renderer)
 			renderer.name = "AynThorRenderer"
+		renderer.set_display_id(display_id)
 		renderer.set_target_fps(target_fps)
+		renderer.set_refresh_divisor(refresh_divisor)
+		renderer.set_present_mode_policy(present_mode)
+		renderer.set_swapchain_format(swapchain_format)
+		renderer.set_swapchain_image_count(swapchain_image_count)
+		renderer.set_frames_in_flight(frames_in_flight)
+		renderer.set_frame_policy(frame_policy)
+		renderer.set_threaded_present(threaded_present)
+		renderer.set_scale_mode(scale_mode)
+		renderer.set_sharpness(sharpness)
 		renderer.set_rotation_degrees(rotation_degrees)
+		renderer.set_compositor_rotation(compositor_rotation)
+		renderer.set_performance_monitors(performance_monitors)
+		renderer.set_latency_probe(latency_probe)
+		renderer.set_capture_fps(capture_fps)
+		renderer.set_capture_scale(capture_scale)
+		renderer.set_direct_mode(direct_mode)
+		renderer.set_dynamic_resolution_min_scale(dynamic_resolution_min)
+		renderer.set_dynamic_resolution_max_scale(dynamic_resolution_max)
+		renderer.set_gpu_budget_ms(gpu_budget_ms)
+		renderer.set_dynamic_resolution(dynamic_resolution)
+		renderer.set_main_update_divisor(main_update_divisor)
+		renderer.set_second_update_divisor(second_update_divisor)
+		renderer.set_update_policy(update_policy)
 	
 	original_main_size = get_viewport().size
 	if original_main_size.x == 0:
@@ -75,8 +251,8 @@ func _ready():
 		_main_viewport.render_target_update_mode = SubViewport.UPDATE_ALWAYS
 		_main_viewport.size = original_main_size
 	if _second_viewport:
-		_second_viewport.render_target_update_mode = SubViewport.UPDATE_ALWAYS
 		_second_viewport.size = original_second_size
+	_apply_second_update_mode()
 
 	if _main_container:
 		_main_container.position = Vector2.ZERO
@@ -86,19 +262,62 @@ func _ready():
 var skip_frames: int = 0
 
 func _process(_delta):
+	if not renderer:
+		return
+
+	# Decides which SubViewports render at the end of this frame; the panel
+	# shows the second one a frame later, once it has rendered.
+	var screen_viewport = _main_viewport if is_swapped else _second_viewport
+	var other_viewport = _second_viewport if is_swapped else _main_viewport
+	var tracking = dirty_tracking and not is_swapped
+	var wanted = (_second_dirty if tracking else true) and renderer.is_window_available()
+	var schedule = renderer.schedule_viewports(other_viewport, screen_viewport, wanted)
+	if tracking:
+		if schedule & renderer.SCHEDULE_SECOND_READY:
+			renderer.mark_dirty(_second_render_damage)
+		if schedule & renderer.SCHEDULE_SECOND_RENDERING:
+			_second_dirty = false
+			_second_render_damage = _second_damage
+
 	if skip_frames > 0:
 		skip_frames -= 1
 		return
 
-	if not renderer or not renderer.is_window_available():
+	var input_target = _main_viewport if is_swapped else _second_viewport
+	if input_target:
+		renderer.flush_touch_input(input_target)
+
+	if not renderer.is_window_available():
 		return
 	
 	if not second_size_confirmed:
 		_try_update_second_screen_size()
 
-	var texture_to_draw = _main_viewport if is_swapped else _second_viewport
-	if texture_to_draw:
-		renderer.draw_viewport_texture(texture_to_draw.get_texture().get_rid())
+	# While swapped the second screen shows the main game at full size.
+	if dynamic_resolution and not is_swapped and _second_viewport and not renderer.is_direct_active():
+		_apply_resolution_scale(renderer.update_dynamic_resolution(_second_viewport.get_viewport_rid()))
+
+	if screen_viewport:
+		# Direct mode falls back to the copy whenever it cannot be used.
+		if direct_mode and renderer.draw_viewport_direct(screen_viewport):
+			return
+		if schedule & renderer.SCHEDULE_SECOND_READY or _present_after_swap:
+			_present_after_swap = false
+			renderer.draw_viewport_texture(screen_viewport.get_texture().get_rid())
+
+func _apply_resolution_scale(scale: float):
+	if is_swapped or not _second_viewport:
+		return
+	var size = Vector2i((Vector2(original_second_size) * scale).round()).max(Vector2i.ONE)
+	# 2D keeps laying out at full size and is stretched, so UI and touch
+	# coordinates do not move when the resolution does.
+	var override = original_second_size if size != original_second_size else Vector2i.ZERO
+	if _second_viewport.size == size and _second_viewport.size_2d_override == override:
+		return
+	_second_viewport.size = size
+	_second_viewport.size_2d_override = override
+	_second_viewport.size_2d_override_stretch = override != Vector2i.ZERO
+	mark_second_screen_dirty()
 
 func _try_update_second_screen_size():
 	if renderer and renderer.is_window_available():
@@ -108,8 +327,32 @@ func _try_update_second_screen_size():
 			second_size_confirmed = true
 			if not is_swapped and _second_viewport:
 				_second_viewport.size = original_second_size
+				mark_second_screen_dirty()
+
+func mark_second_screen_dirty(rect: Rect2i = Rect2i()):
+	if not rect.has_area() or (_second_dirty and not _second_damage.has_area()):
+		_second_damage = Rect2i()
+	elif _second_dirty:
+		_second_damage = _second_damage.merge(rect)
+	else:
+		_second_damage = rect
+	_second_dirty = true
+
+func _apply_second_update_mode():
+	# While swapped the second screen shows the main game, which changes every frame.
+	if dirty_tracking and not is_swapped:
+		mark_second_screen_dirty()
+	if renderer:
+		# The renderer's scheduler sets update modes every frame.
+		renderer.set_dirty_tracking(dirty_tracking and not is_swapped)
+		return
+	if _second_viewport:
+		_second_viewport.render_target_update_mode = SubViewport.UPDATE_DISABLED if dirty_tracking and not is_swapped else SubViewport.UPDATE_ALWAYS
 
 func swap_screens():
+	if swap_mode == SwapMode.SCALED:
+		_swap_scaled()
+		return
 	is_swapped = !is_swapped
 	
 	var second_size = original_second_size
@@ -129,6 +372,8 @@ func swap_screens():
 		
 		if _second_viewport:
 			_second_viewport.size = original_main_size
+			_second_viewport.size_2d_override = Vector2i.ZERO
+			_second_viewport.size_2d_override_stretch = false
 		if _main_viewport:
 			_main_viewport.size = second_size
 	else:
@@ -144,39 +389,27 @@ func swap_screens():
 		if _second_viewport:
 			_second_viewport.size = second_size
 
+	_apply_second_update_mode()
 	screens_swapped.emit(is_swapped)
 	skip_frames = 2
 
-func _on_second_screen_input(action: int, x: float, y: float, pid: int):
-	var event = null
-	var current_pos = Vector2(x, y)
-	
-	if action == 0 or action == 5:
-		last_touch_positions[pid] = current_pos
-		var touch = InputEventScreenTouch.new()
-		touch.pressed = true
-		touch.index = pid
-		touch.position = current_pos
-		event = touch
-	elif action == 1 or action == 6:
-		last_touch_positions.erase(pid)
-		var touch = InputEventScreenTouch.new()
-		touch.pressed = false
-		touch.index = pid
-		touch.position = current_pos
-		event = touch
-	elif action == 2:
-		var drag = InputEventScreenDrag.new()
-		drag.index = pid
-		drag.position = current_pos
-		drag.relative = current_pos - last_touch_positions.get(pid, current_pos)
-		last_touch_positions[pid] = current_pos
-		event = drag
-		
-	if event:
-		var target_vp = _main_viewport if is_swapped else _second_viewport
-		if target_vp:
-			target_vp.push_input(event)
+# A scale-only swap: both SubViewports keep their one render target at its
+# own size, and each is stretched onto the other screen instead. The main
+# display scales its container, the renderer's copy scales to the panel.
+func _swap_scaled():
+	is_swapped = !is_swapped
+	var shown = _second_container if is_swapped else _main_container
+	var hidden = _main_container if is_swapped else _second_container
+	if shown:
+		shown.position = Vector2.ZERO
+		shown.scale = Vector2(original_main_size) / shown.size if shown.size.x > 0 and shown.size.y > 0 else Vector2.ONE
+	if hidden:
+		hidden.position = Vector2(-10000, 0)
+		hidden.scale = Vector2.ONE
+	_apply_second_update_mode()
+	# The newly shown viewport already holds a completed frame.
+	_present_after_swap = true
+	screens_swapped.emit(is_swapped)
 
 func _on_screen_connected():
 	_try_update_second_screen_size()
@@ -191,4 +424,40 @@ enum ScreenRotation {
 	DEG_90 = 90,
 	DEG_180 = 180,
 	DEG_270 = 270
+}
+
+enum FramePolicy {
+	DROP = 0,
+	BLOCK = 1
+}
+
+enum ScaleMode {
+	BLIT = 0,
+	INTEGER = 1,
+	SHARP_BILINEAR = 2,
+	EDGE_ADAPTIVE = 3
+}
+
+enum SwapMode {
+	RESIZE = 0,
+	SCALED = 1
+}
+
+enum UpdatePolicy {
+	ALWAYS = 0,
+	DIVISOR = 1,
+	STAGGERED = 2,
+	VSYNC = 3
+}
+
+enum SwapchainFormat {
+	RGBA8 = 0,
+	LOW_BANDWIDTH = 1,
+	HIGH_PRECISION = 2
+}
+
+enum PresentMode {
+	LOW_LATENCY = 0,
+	VSYNC = 1,
+	ADAPTIVE = 2
 }
\ No newline at end of file
@@ -21,13 +21,24 @@ import org.godotengine.godot.plugin.UsedByGodot
 
 class AynThorPlugin(godot: Godot) : GodotPlugin(godot) {
     private val TAG = "AynThor"
-    private var presentation: SecondScreenPresentation? = null
-    private var isScreenActive = false
+    // Only touched on the UI thread.
+    private val presentations = mutableMapOf<Int, SecondScreenPresentation>()
+    // Displays the game asked for; reopened after a pause.
+    private val requestedDisplays = mutableSetOf<Int>()
+    private var primaryDisplayId = Display.INVALID_DISPLAY
+    // second_screen_input is kept for existing games; AynThorManager reads
+    // the native touch ring instead and turns it off.
+    @Volatile private var inputSignalEnabled = true
 
-    private external fun nativeSetSurface(surface: Surface)
-    private external fun nativeRemoveSurface()
+    private external fun nativeSetSurface(displayId: Int, surface: Surface)
+    private external fun nativeSurfaceChanged(displayId: Int, width: Int, height: Int)
+    private external fun nativeSetRefreshRate(displayId: Int, refreshRate: Float)
+    private external fun nativePushTouches(displayId: Int, count: Int, actions: IntArray, pointerIds: IntArray, coords: FloatArray, times: LongArray)
+    private external fun nativeRemoveSurface(displayId: Int)
 
     companion object {
+        private const val MAX_TOUCH_SAMPLES = 256
+
         init {
             System.loadLibrary("aynthor_native")
         }
@@ -39,13 +50,9 @@ class AynThorPlugin(godot: Godot) : GodotPlugin(godot) {
         return setOf(
             SignalInfo("second_screen_connected"),
             SignalInfo("second_screen_disconnected"),
-            SignalInfo(
-                "second_screen_input",
-                Int::class.javaObjectType,
-                Float::class.javaObjectType,
-                Float::class.javaObjectType,
-                Int::class.javaObjectType
-            )
+            SignalInfo("second_screen_input", Int::class.javaObjectType, Float::class.javaObjectType, Float::class.javaObjectType, Int::class.javaObjectType),
+            SignalInfo("display_connected", Int::class.javaObjectType),
+            SignalInfo("display_disconnected", Int::class.javaObjectType)
         )
     }
 
@@ -77,64 +84,106 @@ class AynThorPlugin(godot: Godot) : GodotPlugin(godot) {
         }
     }
 
+    private fun getDisplayManager(): DisplayManager? {
+        return activity?.getSystemService(Context.DISPLAY_SERVICE) as? DisplayManager
+    }
+
+    private fun findDefaultDisplay(): Display? {
+        val displayManager = getDisplayManager() ?: return null
+        val displays = displayManager.getDisplays(DisplayManager.DISPLAY_CATEGORY_PRESENTATION)
+        return if (displays.isNotEmpty()) {
+            displays[0]
+        } else {
+            displayManager.displays.firstOrNull { it.displayId != Display.DEFAULT_DISPLAY }
+        }
+    }
+
     @UsedByGodot
     fun init_screen() {
-        isScreenActive = true
         activity?.runOnUiThread {
             activity?.window?.decorView?.let { applyImmersiveLogic(it) }
 
-            val displayManager = activity?.getSystemService(Context.DISPLAY_SERVICE) as? DisplayManager
-            if (displayManager == null) return@runOnUiThread
+            val targetDisplay = findDefaultDisplay() ?: return@runOnUiThread
+            primaryDisplayId = targetDisplay.displayId
+            requestedDisplays.add(targetDisplay.displayId)
+            showPresentation(targetDisplay)
+        }
+    }
 
-            val displays = displayManager.getDisplays(DisplayManager.DISPLAY_CATEGORY_PRESENTATION)
-            val targetDisplay = if (displays.isNotEmpty()) {
-                displays[0]
-            } else {
-                displayManager.displays.firstOrNull { it.displayId != Display.DEFAULT_DISPLAY }
-            }
+    @UsedByGodot
+    fun get_external_display_ids(): IntArray {
+        val displayManager = getDisplayManager() ?: return IntArray(0)
+        return displayManager.displays
+            .filter { it.displayId != Display.DEFAULT_DISPLAY }
+            .map { it.displayId }
+            .toIntArray()
+    }
 
-            if (targetDisplay != null) {
-                showPresentation(targetDisplay)
-            }
+    @UsedByGodot
+    fun set_input_signal_enabled(enabled: Boolean) {
+        inputSignalEnabled = enabled
+    }
+
+    @UsedByGodot
+    fun open_display(displayId: Int) {
+        activity?.runOnUiThread {
+            val display = getDisplayManager()?.getDisplay(displayId) ?: return@runOnUiThread
+            requestedDisplays.add(displayId)
+            showPresentation(display)
+        }
+    }
+
+    @UsedByGodot
+    fun close_display(displayId: Int) {
+        activity?.runOnUiThread {
+            requestedDisplays.remove(displayId)
+            dismissPresentation(displayId)
         }
     }
 
     private fun showPresentation(display: Display) {
-        presentation?.dismiss()
-        presentation = SecondScreenPresentation(activity!!, display).apply {
+        presentations.remove(display.displayId)?.dismiss()
+        presentations[display.displayId] = SecondScreenPresentation(activity!!, display).apply {
             window?.setFlags(
                 WindowManager.LayoutParams.FLAG_NOT_FOCUSABLE,
                 WindowManager.LayoutParams.FLAG_NOT_FOCUSABLE
             )
             show()
         }
-        emitSignal("second_screen_connected")
+        emitSignal("display_connected", display.displayId)
+        if (display.displayId == primaryDisplayId) {
+            emitSignal("second_screen_connected")
+        }
     }
 
-    @UsedByGodot
-    fun destroy_screen() {
-        isScreenActive = false
-        activity?.runOnUiThread {
-            presentation?.dismiss()
-            presentation = null
+    private fun dismissPresentation(displayId: Int) {
+        val presentation = presentations.remove(displayId) ?: return
+        presentation.dismiss()
+        emitSignal("display_disconnected", displayId)
+        if (displayId == primaryDisplayId) {
             emitSignal("second_screen_disconnected")
         }
     }
 
-    override fun onMainPause() {
-        super.onMainPause()
+    @UsedByGodot
+    fun destroy_screen() {
         activity?.runOnUiThread {
-            if (presentation != null) {
-                presentation?.dismiss()
-                presentation = null
-            }
+            requestedDisplays.clear()
+            presentations.keys.toList().forEach { dismissPresentation(it) }
+            primaryDisplayId = Display.INVALID_DISPLAY
         }
     }
 
+    // Presentations stay up while paused, so the native side keeps its
+    // surface and swapchain; if the system takes a window away anyway,
+    // surfaceDestroyed/surfaceCreated report it as usual.
     override fun onMainResume() {
         super.onMainResume()
-        if (isScreenActive) {
-            init_screen()
+        activity?.runOnUiThread {
+            val displayManager = getDisplayManager() ?: return@runOnUiThread
+            requestedDisplays.filter { it !in presentations }.forEach { displayId ->
+                displayManager.getDisplay(displayId)?.let { showPresentation(it) }
+            }
         }
     }
 
@@ -143,34 +192,96 @@ class AynThorPlugin(godot: Godot) : GodotPlugin(godot) {
         display: Display
     ) : Presentation(outerContext, display) {
 
-        override fun onCreate(savedInstanceState: Bundle?) {
-            super.onCreate(savedInstanceState)
+        private val displayId = display.displayId
 
-            val surfaceView = SurfaceView(context)
+        // Reused for every MotionEvent so touch handling does not allocate.
+        private val touchActions = IntArray(MAX_TOUCH_SAMPLES)
+        private val touchPointerIds = IntArray(MAX_TOUCH_SAMPLES)
+        private val touchCoords = FloatArray(MAX_TOUCH_SAMPLES * 2)
+        private val touchTimes = LongArray(MAX_TOUCH_SAMPLES)
+        private var touchCount = 0
 
-            surfaceView.setOnTouchListener { _, event ->
-                val action = event.actionMasked
+        private fun addTouch(action: Int, pointerId: Int, x: Float, y: Float, timeNs: Long) {
+            if (touchCount >= MAX_TOUCH_SAMPLES) return
+            touchActions[touchCount] = action
+            touchPointerIds[touchCount] = pointerId
+            touchCoords[touchCount * 2] = x
+            touchCoords[touchCount * 2 + 1] = y
+            touchTimes[touchCount] = timeNs
+            touchCount++
+        }
 
-                if (action == MotionEvent.ACTION_MOVE) {
+        // Full resolution where available; the latency probe measures from it.
+        private fun eventTimeNs(event: MotionEvent): Long =
+            if (Build.VERSION.SDK_INT >= 34) event.eventTimeNanos else event.eventTime * 1_000_000L
+
+        private fun historicalEventTimeNs(event: MotionEvent, pos: Int): Long =
+            if (Build.VERSION.SDK_INT >= 34) event.getHistoricalEventTimeNanos(pos) else event.getHistoricalEventTime(pos) * 1_000_000L
+
+        private fun pushTouchEvent(event: MotionEvent) {
+            touchCount = 0
+            when (val action = event.actionMasked) {
+                MotionEvent.ACTION_MOVE -> {
+                    for (h in 0 until event.historySize) {
+                        val time = historicalEventTimeNs(event, h)
+                        for (i in 0 until event.pointerCount) {
+                            addTouch(action, event.getPointerId(i), event.getHistoricalX(i, h), event.getHistoricalY(i, h), time)
+                        }
+                    }
                     for (i in 0 until event.pointerCount) {
-                        emitSignal("second_screen_input", 2, event.getX(i), event.getY(i), event.getPointerId(i))
+                        addTouch(action, event.getPointerId(i), event.getX(i), event.getY(i), eventTimeNs(event))
                     }
-                } else {
+                }
+                MotionEvent.ACTION_CANCEL -> {
+                    for (i in 0 until event.pointerCount) {
+                        addTouch(action, event.getPointerId(i), event.getX(i), event.getY(i), eventTimeNs(event))
+                    }
+                }
+                else -> {
                     val idx = event.actionIndex
-                    emitSignal("second_screen_input", action, event.getX(idx), event.getY(idx), event.getPointerId(idx))
+                    addTouch(action, event.getPointerId(idx), event.getX(idx), event.getY(idx), eventTimeNs(event))
                 }
+            }
+            nativePushTouches(displayId, touchCount, touchActions, touchPointerIds, touchCoords, touchTimes)
+        }
+
+        // Deprecated per-event signal, current samples only as before.
+        private fun emitInputSignal(event: MotionEvent) {
+            if (!inputSignalEnabled) return
+            if (event.actionMasked == MotionEvent.ACTION_MOVE) {
+                for (i in 0 until event.pointerCount) {
+                    emitSignal("second_screen_input", 2, event.getX(i), event.getY(i), event.getPointerId(i))
+                }
+            } else {
+                val idx = event.actionIndex
+                emitSignal("second_screen_input", event.actionMasked, event.getX(idx), event.getY(idx), event.getPointerId(idx))
+            }
+        }
+
+        override fun onCreate(savedInstanceState: Bundle?) {
+            super.onCreate(savedInstanceState)
+
+            val surfaceView = SurfaceView(context)
+
+            surfaceView.setOnTouchListener { _, event ->
+                pushTouchEvent(event)
+                emitInputSignal(event)
                 true
             }
 
             surfaceView.holder.addCallback(object : SurfaceHolder.Callback {
                 override fun surfaceCreated(holder: SurfaceHolder) {
-                    nativeSetSurface(holder.surface)
+                    nativeSetRefreshRate(displayId, display.refreshRate)
+                    nativeSetSurface(displayId, holder.surface)
                 }
 
-                override fun surfaceChanged(holder: SurfaceHolder, format: Int, width: Int, height: Int) {}
+                override fun surfaceChanged(holder: SurfaceHolder, format: Int, width: Int, height: Int) {
+                    nativeSetRefreshRate(displayId, display.refreshRate)
+                    nativeSurfaceChanged(displayId, width, height)
+                }
 
                 override fun surfaceDestroyed(holder: SurfaceHolder) {
-                    nativeRemoveSurface()
+                    nativeRemoveSurface(displayId)
                 }
             })
 
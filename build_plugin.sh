@@ -49,12 +49,27 @@ library = env.SharedLibrary("bin/libaynthor_native", sources)
 Default(library)
 EOF
 
+echo -e "\033[0;32m--- Unit Tests (Linux) ---\033[0m"
+g++ -O2 -std=c++17 -Isrc src/tests/ayn_thor_viewport_scheduler_test.cpp src/ayn_thor_viewport_scheduler.cpp -o $WORK_DIR/viewport_scheduler_test
+$WORK_DIR/viewport_scheduler_test
+g++ -O2 -std=c++17 -Isrc src/tests/ayn_thor_touch_ring_test.cpp -o $WORK_DIR/touch_ring_test
+$WORK_DIR/touch_ring_test
+
 echo -e "\033[0;32m--- Running SCons (Android) ---\033[0m"
 scons platform=android arch=arm64 target=template_release android_api_level=$ANDROID_API -j$JOBS
 
 echo -e "\033[0;32m--- Running SCons (Windows) ---\033[0m"
 scons platform=windows arch=x86_64 target=template_release use_mingw=yes -j$JOBS
 
+if [ "$BUILD_BENCH" = "1" ]; then
+    echo -e "\033[0;32m--- Building Headless Benchmark (Linux) ---\033[0m"
+    BENCH_DIR="/build/dist/bench"
+    mkdir -p $BENCH_DIR
+    g++ -O2 -std=c++17 -DAYN_THOR_HEADLESS -Isrc src/bench/ayn_thor_bench.cpp src/ayn_thor_blit.cpp src/ayn_thor_frame_stats.cpp src/ayn_thor_present_ring.cpp -lvulkan -o $BENCH_DIR/aynthor_bench
+    # Smoke run on lavapipe; the full matrix is run by hand.
+    VK_ICD_FILENAMES=$(ls /usr/share/vulkan/icd.d/lvp_icd.*.json | head -n 1) $BENCH_DIR/aynthor_bench --quick --csv $BENCH_DIR/quick.csv
+fi
+
 cp bin/libaynthor_native.android.template_release.arm64.so $DIST_DIR/bin/libaynthor_native.so || cp bin/libaynthor_native.so $DIST_DIR/bin/libaynthor_native.so
 cp bin/libaynthor_native.windows.template_release.x86_64.dll $DIST_DIR/bin/libaynthor_native.dll || cp bin/libaynthor_native.dll $DIST_DIR/bin/libaynthor_native.dll
 